@@ -0,0 +1,81 @@
+/**
+ * @file GPIOIf_handle_ops.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Instruction count check of the inline GPIO handle operations
+ *
+ * Each function wraps one handle operation. It is not linked into the
+ * firmware, `make check` compiles it to assembly and counts the
+ * instructions and register accesses of each function with
+ * checks/count_ops.sh. The limits in the Makefile are the sequences
+ * below for arm-none-eabi-gcc -O2 -mcpu=cortex-m4 -mthumb.
+ *
+ * The port operations are functions of the driver, its source is
+ * included so they are inlined into the wrappers like into a caller
+ * with a constant port.
+ */
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "pins.h"
+#include "stm32/stm32f4xx/stm32f4xx_GPIOIf.c"
+
+// handles resolved at compile time, the port address is a literal pool
+// load and the mask an immediate
+
+// ldr r3, .L; movs r2, #128; str r2, [r3, #24]; bx lr
+void check_handle_set(void)
+{
+    GPIOIf_handle_set(GPIOIF_HANDLE(PIN_B_07));
+}
+
+// ldr r3, .L; mov r2, #0x800000; str r2, [r3, #24]; bx lr
+void check_handle_clear(void)
+{
+    GPIOIf_handle_clear(GPIOIF_HANDLE(PIN_B_07));
+}
+
+// ldr r2, .L; ldr r3, [r2, #20]; and r1, r3, #128; mvns r3, r3;
+// and r3, r3, #128; orr r3, r3, r1, lsl #16; str r3, [r2, #24]; bx lr
+void check_handle_toggle(void)
+{
+    GPIOIf_handle_toggle(GPIOIF_HANDLE(PIN_B_07));
+}
+
+// ldr r3, .L; ldr r0, [r3, #16]; and r0, r0, #128; bx lr
+uint32_t check_handle_read(void)
+{
+    return GPIOIf_handle_read(GPIOIF_HANDLE(PIN_B_07));
+}
+
+// handle passed at run time in r0/r1, e.g. stored in a driver. The upper
+// half of r1 is unspecified for the mask, so it is zero extended.
+
+// uxth r1, r1; str r1, [r0, #24]; bx lr
+void check_handle_set_runtime(GPIOIf_handle_t pin)
+{
+    GPIOIf_handle_set(pin);
+}
+
+// ldr r0, [r0, #16]; uxth r1, r1; ands r0, r0, r1; bx lr
+uint32_t check_handle_read_runtime(GPIOIf_handle_t pin)
+{
+    return GPIOIf_handle_read(pin);
+}
+
+// port operations, the port check is resolved at compile time and the
+// pins are changed with a single BSRR store
+
+// ldr r3, .L; ldr r2, .L+4 (or movw/movt); str r2, [r3, #24]; bx lr
+void check_pins_write(void)
+{
+    (void) GPIOIf_pins_write(PIN_B_07, 0x0081, 0x0100);
+}
+
+// ldr r2, .L; ldr r3, [r2, #20]; and r1, r3, #129; mvns r3, r3;
+// and r3, r3, #129; orr r3, r3, r1, lsl #16; str r3, [r2, #24]; bx lr
+void check_pins_toggle(void)
+{
+    (void) GPIOIf_pins_toggle(PIN_B_07, 0x0081);
+}
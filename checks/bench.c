@@ -0,0 +1,105 @@
+/**
+ * @file bench.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Cycle measurement helper and main() of bench.elf
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "bench.h"
+#include "stm32/stm32f4xx/stm32f4xx.h"
+
+bench_result_t bench_results[BENCH_RESULTS] = {};
+uint32_t bench_result_count = 0;
+
+static uint32_t overhead = 0;
+
+static void empty(void)
+{
+}
+
+void bench_init(void)
+{
+    STM32F4xx_CYCCNT_ENABLE();
+
+    // the calibration is not stored as result
+    overhead = 0;
+    bench_result_t *calibration = bench_measure("overhead", NULL, empty);
+    overhead = calibration->min;
+    bench_result_count = 0;
+}
+
+bench_result_t *bench_add(const char *name)
+{
+    if(bench_result_count >= BENCH_RESULTS)
+    {
+        return NULL;
+    }
+
+    bench_result_t *result = &bench_results[bench_result_count++];
+    result->name = name;
+    result->min = UINT32_MAX;
+    result->max = 0;
+
+    return result;
+}
+
+void bench_record(bench_result_t *result, uint32_t cycles)
+{
+    if(result == NULL)
+    {
+        return;
+    }
+    if(cycles < result->min)
+    {
+        result->min = cycles;
+    }
+    if(cycles > result->max)
+    {
+        result->max = cycles;
+    }
+}
+
+bench_result_t *bench_measure(const char *name, void (*setup)(void), void (*run)(void))
+{
+    bench_result_t *result = bench_add(name);
+
+    if(result == NULL)
+    {
+        return NULL;
+    }
+
+    for(uint32_t i = 0; i < BENCH_RUNS; i++)
+    {
+        if(setup != NULL)
+        {
+            setup();
+        }
+
+        uint32_t start = STM32F4xx_CYCCNT();
+        run();
+        uint32_t cycles = STM32F4xx_CYCCNT() - start;
+
+        bench_record(result, (cycles > overhead) ? cycles - overhead : 0);
+    }
+
+    return result;
+}
+
+int main(void)
+{
+    bench_init();
+
+    bench_EXTI();
+    bench_deferred();
+    bench_encoder();
+    bench_softpwm();
+    bench_wakeup();
+
+    // stop here with the debugger and read bench_results
+    while(1)
+    {
+    }
+}
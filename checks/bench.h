@@ -0,0 +1,83 @@
+/**
+ * @file bench.h
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Cycle measurements of the drivers on the target
+ *
+ * `make bench` links the checks/bench*.c files with the drivers to
+ * bench.elf. Each measurement runs a function BENCH_RUNS times between
+ * two reads of the DWT cycle counter and stores the minimum and maximum
+ * number of core cycles in bench_results, which is read with the debugger
+ * once main() has reached its final loop. Interrupts taken during the
+ * function are part of its time, this is how the interrupt handlers are
+ * measured. The flash wait states depend on the core clock, the results
+ * are taken at the reset clock (HSI, no wait states) unless a measurement
+ * configures the clock itself.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "datatypes.h"
+
+// runs per measurement
+#define BENCH_RUNS          64
+
+// maximum number of results
+#define BENCH_RESULTS       32
+
+typedef struct _bench_result
+{
+    const char *name;
+    uint32_t min;                                   // core cycles without the measurement overhead
+    uint32_t max;
+} bench_result_t;
+
+extern bench_result_t bench_results[BENCH_RESULTS];
+extern uint32_t bench_result_count;
+
+/**
+ * @brief Enables the cycle counter and measures the overhead of a
+ *        measurement, which is subtracted from all results
+ */
+void bench_init(void);
+
+/**
+ * @brief Adds an empty result, e.g. for latencies which are recorded with
+ *        bench_record()
+ *
+ * @param  char *name               : Name of the result
+ * @return bench_result_t *result   : The new result, NULL if bench_results
+ *                                    is full
+ */
+bench_result_t *bench_add(const char *name);
+
+/**
+ * @brief Records a number of cycles in a result
+ *
+ * @param  bench_result_t *result   : Result of bench_add(), may be NULL
+ * @param  uint32_t cycles          : Measured core cycles
+ */
+void bench_record(bench_result_t *result, uint32_t cycles);
+
+/**
+ * @brief Measures the cycles of run
+ *
+ * @param  char *name               : Name of the result
+ * @param  void (*setup)(void)      : Called before each run outside of the
+ *                                    measurement, may be NULL
+ * @param  void (*run)(void)        : Function which is measured
+ * @return bench_result_t *result   : The stored result, NULL if
+ *                                    bench_results is full
+ */
+bench_result_t *bench_measure(const char *name, void (*setup)(void), void (*run)(void));
+
+// measurements, one function per driver
+void bench_EXTI(void);
+void bench_deferred(void);
+void bench_encoder(void);
+void bench_softpwm(void);
+void bench_wakeup(void);
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * @file bench_EXTI.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Cycles of the shared EXTI dispatcher for 1 and 6 pending lines
+ *
+ * Lines 10-15 are registered as software signals with an empty handler,
+ * so they need no pins. A write to EXTI_SWIER sets one or all six lines
+ * pending at once, the EXTI15_10 interrupt serves them in one entry. The
+ * results include exception entry and exit and the SWIER store.
+ */
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "bench.h"
+#include "stm32/stm32f4xx/stm32f4xx.h"
+
+#define BENCH_EXTI_FIRST_LINE   10
+#define BENCH_EXTI_LINES        6
+#define BENCH_EXTI_PRIORITY     8
+
+static void handler(void)
+{
+}
+
+static void raise_lines(uint32_t lines)
+{
+    STM32F4xx_EXTI->EXTI_SWIER = lines;
+    // the interrupt is taken before the measurement ends
+    STM32F4xx_DSB();
+    STM32F4xx_ISB();
+}
+
+static void raise_one(void)
+{
+    raise_lines(1UL << BENCH_EXTI_FIRST_LINE);
+}
+
+static void raise_all(void)
+{
+    raise_lines(((1UL << BENCH_EXTI_LINES) - 1) << BENCH_EXTI_FIRST_LINE);
+}
+
+void bench_EXTI(void)
+{
+    for(uint8_t line = BENCH_EXTI_FIRST_LINE; line < BENCH_EXTI_FIRST_LINE + BENCH_EXTI_LINES; line++)
+    {
+        if(GPIOIf_signal_register(line, handler, BENCH_EXTI_PRIORITY) != E_OK)
+        {
+            return;
+        }
+    }
+
+    (void) bench_measure("EXTI15_10 1 line", NULL, raise_one);
+    (void) bench_measure("EXTI15_10 6 lines", NULL, raise_all);
+
+    for(uint8_t line = BENCH_EXTI_FIRST_LINE; line < BENCH_EXTI_FIRST_LINE + BENCH_EXTI_LINES; line++)
+    {
+        (void) GPIOIf_signal_unregister(line);
+    }
+}
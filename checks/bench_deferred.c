@@ -0,0 +1,128 @@
+/**
+ * @file bench_deferred.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Interrupt time and latency of direct and deferred EXTI callbacks
+ *
+ * PA0 is configured with a callback which runs BENCH_DEFERRED_CALLBACK
+ * cycles, EXTI_SWIER raises its line without an edge on the pin. Two
+ * values are measured for the callback called from the interrupt and for
+ * GPIOIF_EXTI_DEFERRED:
+ *
+ * - the time of the EXTI0 interrupt including entry and exit. PendSV is
+ *   masked with BASEPRI while it is measured, the deferred callback runs
+ *   outside of the measurement.
+ * - the latency of another interrupt of the same priority (signal line
+ *   16) which the callback raises as first action, from the raise to the
+ *   entry of its handler.
+ */
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "pins.h"
+#include "bench.h"
+#include "stm32/stm32f4xx/stm32f4xx.h"
+#include "stm32/stm32f4xx/stm32f4xx_interrupt.h"
+
+#define BENCH_DEFERRED_LINE         0
+#define BENCH_DEFERRED_VICTIM_LINE  16
+#define BENCH_DEFERRED_PRIORITY     8
+#define BENCH_DEFERRED_CALLBACK     1000
+
+// BASEPRI which only masks the lowest priority, i.e. PendSV
+#define BENCH_MASK_PENDSV           (STM32F4xx_NVIC_MAX_PRIORITY << (8 - STM32F4xx_NVIC_PRIO_BITS))
+
+static bench_result_t *latency = NULL;
+static boolean raise_victim = FALSE;
+static volatile uint32_t raised = 0;
+
+static void callback(void)
+{
+    if(raise_victim == TRUE)
+    {
+        raised = STM32F4xx_CYCCNT();
+        STM32F4xx_EXTI->EXTI_SWIER = 1UL << BENCH_DEFERRED_VICTIM_LINE;
+    }
+
+    uint32_t start = STM32F4xx_CYCCNT();
+    while(STM32F4xx_CYCCNT() - start < BENCH_DEFERRED_CALLBACK)
+    {
+    }
+}
+
+static void victim(void)
+{
+    bench_record(latency, STM32F4xx_CYCCNT() - raised);
+}
+
+static void raise_line(void)
+{
+    STM32F4xx_EXTI->EXTI_SWIER = 1UL << BENCH_DEFERRED_LINE;
+    // the interrupt is taken before the measurement ends
+    STM32F4xx_DSB();
+    STM32F4xx_ISB();
+}
+
+// runs the deferred callbacks of the previous run
+static void unmask_pendsv(void)
+{
+    __asm volatile ("msr basepri, %0" :: "r" (0) : "memory");
+}
+
+static void raise_masked(void)
+{
+    __asm volatile ("msr basepri, %0" :: "r" (BENCH_MASK_PENDSV) : "memory");
+    raise_line();
+}
+
+static void measure(GPIOIf_pin_config_t *cfg, uint8_t exti_flags, const char *isr_name, const char *latency_name)
+{
+    cfg->exti_flags = exti_flags;
+    if(GPIOIf_config_pin(cfg) != E_OK)
+    {
+        return;
+    }
+
+    raise_victim = FALSE;
+    (void) bench_measure(isr_name, unmask_pendsv, raise_masked);
+    unmask_pendsv();
+
+    latency = bench_add(latency_name);
+    raise_victim = TRUE;
+    for(uint32_t i = 0; i < BENCH_RUNS; i++)
+    {
+        raise_line();
+    }
+    raise_victim = FALSE;
+}
+
+void bench_deferred(void)
+{
+    GPIOIf_pin_config_t cfg =
+    {
+        .callback = callback,
+        .pin = PIN_A_00,
+        .pin_mode = GPIOIf_INPUT,
+        .pullup_mode = GPIOIf_PULLDOWN,
+        .trigger = GPIOIf_RISING_EDGE,
+        .priority = BENCH_DEFERRED_PRIORITY,
+        .set_priority = TRUE,
+    };
+
+    if(GPIOIf_init(PORT_A) != E_OK)
+    {
+        return;
+    }
+    if(GPIOIf_signal_register(BENCH_DEFERRED_VICTIM_LINE, victim, BENCH_DEFERRED_PRIORITY) != E_OK)
+    {
+        return;
+    }
+
+    measure(&cfg, GPIOIF_EXTI_CALLBACK, "EXTI0 callback ISR", "EXTI0 callback latency");
+    measure(&cfg, GPIOIF_EXTI_DEFERRED, "EXTI0 deferred ISR", "EXTI0 deferred latency");
+
+    cfg.trigger = GPIOIf_NO_TRIGGER;
+    (void) GPIOIf_config_pin(&cfg);
+    (void) GPIOIf_signal_unregister(BENCH_DEFERRED_VICTIM_LINE);
+}
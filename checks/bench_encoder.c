@@ -0,0 +1,70 @@
+/**
+ * @file bench_encoder.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Interrupt time per edge of the quadrature decoder
+ *
+ * Encoder 0 decodes PC0 (phase A, EXTI0) and PC1 (phase B, EXTI1).
+ * EXTI_SWIER raises the lines without an edge on the pins, the decoder
+ * then runs its complete table lookup for an unchanged state, which
+ * takes as long as a valid transition. Measured are one edge and an edge
+ * of both phases at the same time, which are served by two tail-chained
+ * interrupts. An edge is lost if the next edge of the encoder occurs
+ * before the interrupt has read IDR, so the core clock divided by the
+ * cycles of one edge is the upper bound of the sustainable edge rate,
+ * e.g. 100 MHz / 100 cycles = 1 M edges/s.
+ */
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "EncoderIf.h"
+#include "pins.h"
+#include "bench.h"
+#include "stm32/stm32f4xx/stm32f4xx.h"
+
+#define BENCH_ENCODER_ID        0
+#define BENCH_ENCODER_LINE_A    0
+#define BENCH_ENCODER_LINE_B    1
+
+static void raise_lines(uint32_t lines)
+{
+    STM32F4xx_EXTI->EXTI_SWIER = lines;
+    // the interrupts are taken before the measurement ends
+    STM32F4xx_DSB();
+    STM32F4xx_ISB();
+}
+
+static void raise_one(void)
+{
+    raise_lines(1UL << BENCH_ENCODER_LINE_A);
+}
+
+static void raise_both(void)
+{
+    raise_lines((1UL << BENCH_ENCODER_LINE_A) | (1UL << BENCH_ENCODER_LINE_B));
+}
+
+void bench_encoder(void)
+{
+    const EncoderIf_config_t cfg =
+    {
+        .pin_a = PIN_C_00,
+        .pin_b = PIN_C_01,
+        .pullup_mode = GPIOIf_PULLUP,
+    };
+
+    if(GPIOIf_init(PORT_C) != E_OK)
+    {
+        return;
+    }
+    if(EncoderIf_init(BENCH_ENCODER_ID, &cfg) != E_OK)
+    {
+        return;
+    }
+
+    (void) bench_measure("encoder 1 edge", NULL, raise_one);
+    (void) bench_measure("encoder 2 edges", NULL, raise_both);
+
+    (void) EncoderIf_deinit(BENCH_ENCODER_ID);
+}
@@ -0,0 +1,155 @@
+/**
+ * @file bench_softpwm.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Interrupt cost of the software PWM against the channel count
+ *
+ * 1, 2, 4, 8 and 16 channels on PC0-PC15 run with different duty cycles,
+ * i.e. one event per channel and one start event of the port per period.
+ * The TIM2 vector is replaced by a wrapper which measures TIM2_Handler()
+ * without exception entry and exit. For each channel count the cycles of
+ * one interrupt and the sum of all interrupts of a period are stored. A
+ * last run with 16 channels of the same duty cycle shows the merged
+ * events. PC13-PC15 must not be used by the RTC or the LSE oscillator.
+ */
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "SoftPwmIf.h"
+#include "pins.h"
+#include "bench.h"
+#include "stm32/stm32f4xx/stm32f4xx.h"
+#include "stm32/stm32f4xx/stm32f4xx_interrupt.h"
+
+#define BENCH_SOFTPWM_FREQUENCY     1000
+#define BENCH_SOFTPWM_RESOLUTION    100
+#define BENCH_SOFTPWM_CHANNELS      16
+#define BENCH_SOFTPWM_SETTLE        2       // periods until a new schedule is active
+#define BENCH_SOFTPWM_PERIODS       16      // measured periods per channel count
+
+typedef struct _bench_softpwm_case
+{
+    uint8_t channels;
+    boolean merged;                         // all channels use the same duty cycle
+    const char *isr_name;
+    const char *period_name;
+} bench_softpwm_case_t;
+
+static const bench_softpwm_case_t cases[] =
+{
+    { 1,  FALSE, "softpwm 1 ch ISR",         "softpwm 1 ch period" },
+    { 2,  FALSE, "softpwm 2 ch ISR",         "softpwm 2 ch period" },
+    { 4,  FALSE, "softpwm 4 ch ISR",         "softpwm 4 ch period" },
+    { 8,  FALSE, "softpwm 8 ch ISR",         "softpwm 8 ch period" },
+    { 16, FALSE, "softpwm 16 ch ISR",        "softpwm 16 ch period" },
+    { 16, TRUE,  "softpwm 16 ch merged ISR", "softpwm 16 ch merged period" },
+};
+
+static bench_result_t *isr_result = NULL;
+static bench_result_t *period_result = NULL;
+static volatile uint32_t periods = 0;
+static uint32_t period_cycles = 0;
+static uint16_t last_count = 0;
+
+static void measured_handler(void)
+{
+    uint16_t count = (uint16_t) STM32F4xx_TIM2->CNT;
+
+    // the counter wrapped since the last interrupt, i.e. this is the
+    // start event of a new period
+    if(count < last_count)
+    {
+        if(periods > 0)
+        {
+            bench_record(period_result, period_cycles);
+        }
+        period_cycles = 0;
+        periods++;
+    }
+    last_count = count;
+
+    uint32_t start = STM32F4xx_CYCCNT();
+    TIM2_Handler();
+    uint32_t cycles = STM32F4xx_CYCCNT() - start;
+
+    bench_record(isr_result, cycles);
+    period_cycles += cycles;
+}
+
+static void wait_periods(uint32_t count)
+{
+    uint32_t end = periods + count;
+
+    while(periods < end)
+    {
+    }
+}
+
+static void measure(const bench_softpwm_case_t *c)
+{
+    for(uint8_t i = 0; i < BENCH_SOFTPWM_CHANNELS; i++)
+    {
+        uint16_t duty = (c->merged == TRUE) ? BENCH_SOFTPWM_RESOLUTION / 2
+                                            : (uint16_t) ((i + 1) * BENCH_SOFTPWM_RESOLUTION / (c->channels + 1));
+
+        if(i < c->channels)
+        {
+            (void) SoftPwmIf_set_duty((GPIOIf_pin_t) (PIN_C_00 + i), duty);
+        }
+        else
+        {
+            (void) SoftPwmIf_remove_pin((GPIOIf_pin_t) (PIN_C_00 + i));
+        }
+    }
+
+    // the interrupts of the previous schedule are not recorded
+    isr_result = NULL;
+    period_result = NULL;
+    wait_periods(BENCH_SOFTPWM_SETTLE);
+
+    isr_result = bench_add(c->isr_name);
+    period_result = bench_add(c->period_name);
+    wait_periods(BENCH_SOFTPWM_PERIODS);
+    isr_result = NULL;
+    period_result = NULL;
+}
+
+void bench_softpwm(void)
+{
+    GPIOIf_pin_config_t cfg =
+    {
+        .pin_mode = GPIOIf_OUTPUT,
+        .output_mode = GPIOIF_OUTPUT_PUSH_PULL,
+    };
+
+    if(GPIOIf_init(PORT_C) != E_OK)
+    {
+        return;
+    }
+    for(uint8_t i = 0; i < BENCH_SOFTPWM_CHANNELS; i++)
+    {
+        cfg.pin = (GPIOIf_pin_t) (PIN_C_00 + i);
+        if(GPIOIf_config_pin(&cfg) != E_OK)
+        {
+            return;
+        }
+    }
+    if(SoftPwmIf_init(BENCH_SOFTPWM_FREQUENCY, BENCH_SOFTPWM_RESOLUTION) != E_OK)
+    {
+        return;
+    }
+    if(stm32f4xx_register_irq_handler(STM32F4xx_TIM2_IRQ, measured_handler) != E_OK)
+    {
+        (void) SoftPwmIf_deinit();
+        return;
+    }
+
+    for(uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        measure(&cases[i]);
+    }
+
+    (void) SoftPwmIf_deinit();
+    (void) stm32f4xx_restore_irq_handler(STM32F4xx_TIM2_IRQ);
+}
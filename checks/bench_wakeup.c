@@ -0,0 +1,115 @@
+/**
+ * @file bench_wakeup.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief Wake-to-response latency of event mode and interrupt wakeup
+ *
+ * The waveform output drives rising edges on PB0 without CPU load, the
+ * pin is an output and its edge trigger sees its own level. The core
+ * sleeps in WFE for each edge and responds either directly after WFE
+ * (GPIOIF_EXTI_EVENT) or in the callback of the EXTI0 interrupt. The
+ * response reads TIM1->CNT, which restarts at the update event that
+ * requests the edge, so the latency includes the constant delay of the
+ * DMA transfer to BSRR. TIM1 is assumed to count core clock cycles
+ * divided by its prescaler, i.e. APB2 runs undivided as after reset.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "pins.h"
+#include "bench.h"
+#include "stm32/stm32f4xx/stm32f4xx.h"
+
+#define BENCH_WAKEUP_PIN        PIN_B_00
+#define BENCH_WAKEUP_MASK       0x0001
+#define BENCH_WAKEUP_RATE       10000   // words per second, one edge every 2 words
+#define BENCH_WAKEUP_PRIORITY   8
+
+static uint32_t waveform[2 * BENCH_RUNS];
+static bench_result_t *latency = NULL;
+static volatile uint32_t responses = 0;
+
+static inline __attribute__((always_inline)) uint32_t cycles_since_edge(void)
+{
+    return STM32F4xx_TIM1->CNT * (STM32F4xx_TIM1->PSC + 1);
+}
+
+static void callback(void)
+{
+    uint32_t cycles = cycles_since_edge();
+
+    bench_record(latency, cycles);
+    responses++;
+}
+
+static boolean start(GPIOIf_pin_config_t *cfg, uint8_t exti_flags, const char *name)
+{
+    cfg->exti_flags = exti_flags;
+    cfg->callback = (exti_flags == GPIOIF_EXTI_EVENT) ? NULL : callback;
+    if(GPIOIf_config_pin(cfg) != E_OK)
+    {
+        return FALSE;
+    }
+
+    latency = bench_add(name);
+    responses = 0;
+
+    return (GPIOIf_waveform_start(BENCH_WAKEUP_PIN, BENCH_WAKEUP_RATE, waveform, NULL,
+                                  sizeof(waveform) / sizeof(waveform[0]), NULL) == E_OK) ? TRUE : FALSE;
+}
+
+void bench_wakeup(void)
+{
+    GPIOIf_handle_t pin = GPIOIF_HANDLE(BENCH_WAKEUP_PIN);
+    GPIOIf_pin_config_t cfg =
+    {
+        .pin = BENCH_WAKEUP_PIN,
+        .pin_mode = GPIOIf_OUTPUT,
+        .output_mode = GPIOIF_OUTPUT_PUSH_PULL,
+        .trigger = GPIOIf_RISING_EDGE,
+        .priority = BENCH_WAKEUP_PRIORITY,
+        .set_priority = TRUE,
+    };
+
+    for(uint32_t i = 0; i < BENCH_RUNS; i++)
+    {
+        waveform[2 * i]     = GPIOIF_WAVEFORM_WORD(0, BENCH_WAKEUP_MASK);
+        waveform[2 * i + 1] = GPIOIF_WAVEFORM_WORD(BENCH_WAKEUP_MASK, 0);
+    }
+    if(GPIOIf_init(PORT_B) != E_OK)
+    {
+        return;
+    }
+
+    // event mode: the core resumes after WFE without vectoring
+    if(start(&cfg, GPIOIF_EXTI_EVENT, "wakeup event") == TRUE)
+    {
+        for(uint32_t i = 0; i < BENCH_RUNS; i++)
+        {
+            while(GPIOIf_handle_read(pin) != 0)
+            {
+            }
+            while(GPIOIf_handle_read(pin) == 0)
+            {
+                GPIOIf_wait_for_event();
+            }
+            bench_record(latency, cycles_since_edge());
+        }
+    }
+    (void) GPIOIf_waveform_stop();
+
+    // interrupt: the core vectors to EXTI0 from WFE
+    if(start(&cfg, GPIOIF_EXTI_CALLBACK, "wakeup interrupt") == TRUE)
+    {
+        while(responses < BENCH_RUNS)
+        {
+            GPIOIf_wait_for_event();
+        }
+    }
+    (void) GPIOIf_waveform_stop();
+
+    cfg.trigger = GPIOIf_NO_TRIGGER;
+    (void) GPIOIf_config_pin(&cfg);
+}
@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# Counts the instructions and register accesses of a function in an
+# assembly file generated by arm-none-eabi-gcc -S. Fails if the function
+# has more instructions than allowed or another number of accesses.
+#
+# Usage: count_ops.sh <file.s> <function> <max instructions> <accesses>
+#
+
+if [ $# -ne 4 ]; then
+    echo "usage: $0 <file.s> <function> <max instructions> <accesses>" >&2
+    exit 2
+fi
+
+awk -v fn="$2" -v max="$3" -v accesses="$4" '
+    $0 == fn ":" { inside = 1; next }
+    inside && $1 == ".size" { inside = 0 }
+    # instructions are indented, directives and labels are not counted
+    inside && /^\t[a-z]/ {
+        count++
+        # loads and stores through a base register, loads from the
+        # literal pool reference a label instead
+        if($1 ~ /^(ldr|str)/ && $0 ~ /\[/)
+        {
+            mmio++
+        }
+    }
+    END {
+        printf "%-28s %2d instructions (max %d), %d register accesses (expected %d)\n",
+               fn, count, max, mmio, accesses
+        if(count == 0 || count > max || mmio != accesses)
+        {
+            exit 1
+        }
+    }
+' "$1"
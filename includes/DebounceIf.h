@@ -0,0 +1,87 @@
+/**
+ * @file DebounceIf.h
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief File containing API for debouncing digital inputs
+ *
+ * This file specifies a generic API which shall be used to
+ * debounce slow digital inputs, e.g. switches and buttons.
+ * Instead of an interrupt per edge, whole ports are sampled
+ * from a periodic tick and all pins of a port are debounced
+ * in parallel. A pin changes its debounced state after it has
+ * been sampled with the new level 4 times in a row, i.e. with
+ * a tick of 5ms bounces of up to 15ms are filtered.
+ */
+
+#ifndef DEBOUNCEIF_H
+#define DEBOUNCEIF_H
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+
+/**
+ * @brief Callback of debounced transitions
+ *
+ * Called from DebounceIf_tick() once per tick and port if at least one
+ * of the debounced pins of the port has changed its state.
+ *
+ * @param  GPIOIf_pin_t port        : Port of the pins
+ * @param  uint16_t changed         : Pins which changed their state
+ * @param  uint16_t state           : Debounced state of all pins of the port
+ */
+typedef void (*DebounceIf_callback_t)(GPIOIf_pin_t port, uint16_t changed, uint16_t state);
+
+/**
+ * @brief Adds pins of a port to the debouncing
+ *
+ * Starts to debounce the pins in mask of the given port. The pins have
+ * to be configured as inputs, an external interrupt (trigger) is not
+ * required. The debounced state starts with the current level of the
+ * pins. If the port is already debounced, mask and callback are replaced.
+ *
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @param  uint16_t mask            : Pins to be debounced
+ * @param  DebounceIf_callback_t callback: Callback of transitions, can be
+ *                                    NULL if the state is polled
+ * @return std_return_type_t status : If the port is not available the
+ *                                    function returns E_NOT_EXISTING.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t DebounceIf_add_port(GPIOIf_pin_t port, uint16_t mask, DebounceIf_callback_t callback);
+
+/**
+ * @brief Removes a port from the debouncing
+ *
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @return std_return_type_t status : If the port is not available the
+ *                                    function returns E_NOT_EXISTING.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t DebounceIf_remove_port(GPIOIf_pin_t port);
+
+/**
+ * @brief Reads the debounced state of a port
+ *
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @param  uint16_t *state          : Debounced state, only the pins added
+ *                                    with DebounceIf_add_port() are valid
+ * @return std_return_type_t status : If the port is not available the
+ *                                    function returns E_NOT_EXISTING. If
+ *                                    the port is not debounced the
+ *                                    function returns E_STATE_NOINIT. If
+ *                                    state is NULL the function returns
+ *                                    E_VALUE_NULL. Else it returns E_OK.
+ */
+std_return_type_t DebounceIf_get_state(GPIOIf_pin_t port, uint16_t *state);
+
+/**
+ * @brief Samples and debounces all ports
+ *
+ * Shall be called periodically with a fixed period of 1-10ms, e.g. from
+ * a timer interrupt or SysTick. Each debounced port is read once and the
+ * callbacks of changed ports are called from this function.
+ */
+void DebounceIf_tick(void);
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file EncoderIf.h
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief File containing API for quadrature encoders
+ *
+ * This file specifies a generic API which shall be used to
+ * read incremental quadrature encoders connected to GPIO's.
+ * Each edge of phase A and B is decoded in the external
+ * interrupt of the pins, i.e. the position is counted in
+ * quadrature (4 counts per encoder line).
+ */
+
+#ifndef ENCODERIF_H
+#define ENCODERIF_H
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+
+/**
+ * @brief Configuration of an encoder
+ *
+ * Phase A and B have to be pins of the same port, which use different
+ * external interrupt lines (pin numbers), i.e. no other pin with the
+ * same pin number may use an edge trigger.
+ */
+typedef struct __EncoderIf_config
+{
+    GPIOIf_pin_t pin_a;                 // phase A
+    GPIOIf_pin_t pin_b;                 // phase B
+    GPIOIf_pullup_mode_t pullup_mode;   // pullup of both phases
+} EncoderIf_config_t;
+
+/**
+ * @brief Initializes an encoder
+ *
+ * Configures both phases as inputs with interrupts on both edges and
+ * resets the position to 0. The ports of the pins have to be initialized
+ * with GPIOIf_init().
+ *
+ * @param  identifier_t encoder_id  : Encoder to be initialized
+ * @param  EncoderIf_config_t *cfg  : Encoder configuration
+ * @return std_return_type_t status : If the encoder id does not exist the
+ *                                    function returns E_NOT_EXISTING. If cfg
+ *                                    is NULL the function returns
+ *                                    E_VALUE_NULL. If the pins are not on
+ *                                    the same port or use the same line
+ *                                    the function returns E_CFG_ERR. Else
+ *                                    it returns the status of
+ *                                    GPIOIf_config_pins().
+ */
+std_return_type_t EncoderIf_init(identifier_t encoder_id, const EncoderIf_config_t *cfg);
+
+/**
+ * @brief Deinitializes an encoder
+ *
+ * Disables the interrupts of both phases.
+ *
+ * @param  identifier_t encoder_id  : Encoder to be deinitialized
+ * @return std_return_type_t status : If the encoder id does not exist the
+ *                                    function returns E_NOT_EXISTING. If the
+ *                                    encoder is not initialized the function
+ *                                    returns E_STATE_NOINIT. Else it returns
+ *                                    E_OK.
+ */
+std_return_type_t EncoderIf_deinit(identifier_t encoder_id);
+
+/**
+ * @brief Reads the position of an encoder
+ *
+ * @param  identifier_t encoder_id  : Encoder to be read
+ * @return int32_t position         : Position in quadrature counts, 0 if the
+ *                                    encoder does not exist.
+ */
+int32_t EncoderIf_get_position(identifier_t encoder_id);
+
+/**
+ * @brief Sets the position of an encoder
+ *
+ * @param  identifier_t encoder_id  : Encoder to be set
+ * @param  int32_t position         : New position in quadrature counts
+ * @return std_return_type_t status : If the encoder id does not exist the
+ *                                    function returns E_NOT_EXISTING. Else
+ *                                    it returns E_OK.
+ */
+std_return_type_t EncoderIf_set_position(identifier_t encoder_id, int32_t position);
+
+/**
+ * @brief Reads the number of invalid transitions of an encoder
+ *
+ * A transition is invalid if both phases changed between two interrupts,
+ * i.e. at least one edge was lost because the edge rate was too high.
+ *
+ * @param  identifier_t encoder_id  : Encoder to be read
+ * @return uint32_t errors          : Number of invalid transitions since
+ *                                    the initialization, 0 if the encoder
+ *                                    does not exist.
+ */
+uint32_t EncoderIf_get_errors(identifier_t encoder_id);
+
+#endif
@@ -14,6 +14,7 @@
 #define GPIOIF_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <datatypes.h>
 
 #define GPIOIf_get_port(id) (id | 0x00FF)
@@ -58,6 +59,29 @@ typedef enum __GPIOIf_output_mode
     GPIOIF_OUTPUT_OPEN_DRAIN=    0x02,
 }GPIOIf_output_mode_t;
 
+/**
+ * @brief Output speed (slew rate) of a pin
+ *
+ * The speed classes are ordered from slowest edges/lowest EMI to fastest 
+ * edges. The aliases describe typical signal classes. If GPIOIF_SPEED_DEFAULT
+ * is used, outputs are configured as GPIOIF_SPEED_LOW_EMI and alternate 
+ * function pins as GPIOIF_SPEED_PERIPHERAL, the speed of inputs is not 
+ * changed.
+ */
+typedef enum _GPIOIf_output_speed
+{
+    GPIOIF_SPEED_DEFAULT        = 0x00, // default of the signal class of the pin mode
+    GPIOIF_SPEED_LOW            = 0x01, // slowest edges
+    GPIOIF_SPEED_MEDIUM         = 0x02,
+    GPIOIF_SPEED_HIGH           = 0x03,
+    GPIOIF_SPEED_VERY_HIGH      = 0x04, // fastest edges
+
+    GPIOIF_SPEED_LOW_EMI        = GPIOIF_SPEED_LOW,         // LEDs, enable and reset lines, long cables
+    GPIOIF_SPEED_BIT_BANG       = GPIOIF_SPEED_MEDIUM,      // software driven protocols
+    GPIOIF_SPEED_PERIPHERAL     = GPIOIF_SPEED_HIGH,        // UART, I2C, timer outputs
+    GPIOIF_SPEED_HIGH_SPEED_BUS = GPIOIF_SPEED_VERY_HIGH,   // SPI, SDIO, parallel display buses
+} GPIOIf_output_speed_t;
+
 typedef enum
 {
     GPIOIf_NO_TRIGGER    = 0x00,
@@ -66,6 +90,48 @@ typedef enum
     GPIOIf_BOTH_EDGES    = 0x03,
 } GPIOIf_trigger_t;
 
+/**
+ * @brief Options of the external interrupt of a pin
+ *
+ * The flags can be combined with a bitwise or.
+ * 
+ * GPIOIF_EXTI_CALLBACK    : the callback is called from the interrupt
+ * GPIOIF_EXTI_TIMESTAMP   : each edge is timestamped as first action of the
+ *                           interrupt and stored with the pin level in a 
+ *                           buffer of the pin, see GPIOIf_get_edge_event().
+ *                           The callback is optional in this mode.
+ * GPIOIF_EXTI_DEFERRED    : the interrupt only queues the edge, the callback
+ *                           is called from GPIOIf_process_events() outside
+ *                           of the interrupt context. MCUs with a deferred 
+ *                           work queue call it themselves at the lowest 
+ *                           interrupt priority. An edge queued before the
+ *                           pin is reconfigured calls the callback it was
+ *                           queued with. Combined with GPIOIF_EXTI_TIMESTAMP
+ *                           the edges are timestamped as well.
+ * GPIOIF_EXTI_EVENT       : the edge does not trigger an interrupt, it only
+ *                           generates a wakeup event, which resumes the core
+ *                           from GPIOIf_wait_for_event() without an exception
+ *                           entry and exit. The callback is not used and the
+ *                           flag can not be combined with the other flags.
+ */
+typedef enum _GPIOIf_exti_flags
+{
+    GPIOIF_EXTI_CALLBACK    = 0x00,
+    GPIOIF_EXTI_TIMESTAMP   = 0x01,
+    GPIOIF_EXTI_DEFERRED    = 0x02,
+    GPIOIF_EXTI_EVENT       = 0x04,
+} GPIOIf_exti_flags_t;
+
+/**
+ * @brief Timestamped edge of an input pin
+ */
+typedef struct __GPIOIf_edge_event
+{
+    uint32_t timestamp;                 // free running core clock cycle counter 
+    GPIOIf_pin_t pin;                   // pin which triggered the interrupt
+    uint8_t level;                      // level of the pin when the interrupt was served
+} GPIOIf_edge_event_t;
+
 typedef struct __GPIOIf_pin_config
 { 
     void (*callback)(void);
@@ -75,6 +141,11 @@ typedef struct __GPIOIf_pin_config
     GPIOIf_pullup_mode_t pullup_mode;
     GPIOIf_output_mode_t output_mode;
     GPIOIf_trigger_t trigger;
+    uint8_t exti_flags;                 // combination of GPIOIf_exti_flags_t
+    uint8_t priority;                   // interrupt priority of the trigger, 0 is the highest priority, the MCU
+                                        // rejects priorities which its critical sections can not mask
+    GPIOIf_output_speed_t output_speed;
+    boolean set_priority;               // TRUE applies priority, FALSE keeps the current priority
 } GPIOIf_pin_config_t;
 
 
@@ -114,11 +185,54 @@ std_return_type_t GPIOIf_deinit(GPIOIf_pin_t port);
  *                                    the functionality is not implemented on 
  *                                    the function returns E_NOT_IMPLEMENTED.
  *                                    If the pin does not exist the function
- *                                    returns E_NOT_EXISTING. Else it returns 
+ *                                    returns E_NOT_EXISTING. If the priority
+ *                                    is out of range the function returns
+ *                                    E_VALUE_OUT_OF_RANGE. Else it returns 
  *                                    E_OK.
  */
 std_return_type_t GPIOIf_config_pin(GPIOIf_pin_config_t *cfg);
 
+/**
+ * @brief Configuration of several pins
+ *  
+ * This function configures a list of pins at once. The configurations are
+ * grouped by port and each configuration register is written only once per
+ * port, which is considerably faster than calling GPIOIf_config_pin() for
+ * every pin. All configurations are checked before the first register is 
+ * written, i.e. if one of the configurations is invalid, no pin is changed.
+ * If a pin is part of the list several times, the last entry is used.
+ * The function may be called from threads and interrupts concurrently,
+ * only the configuration bits which are changed by the list are merged
+ * into the current configuration of a port.
+ * 
+ * @param  GPIOIf_pin_config_t *cfgs: Pin configurations
+ * @param  size_t n                 : Number of pin configurations
+ * @return std_return_type_t status : If cfgs is NULL the function returns
+ *                                    E_VALUE_NULL. Else the function returns 
+ *                                    the same values as GPIOIf_config_pin() 
+ *                                    for the first invalid configuration or
+ *                                    E_OK.
+ */
+std_return_type_t GPIOIf_config_pins(const GPIOIf_pin_config_t *cfgs, size_t n);
+
+/**
+ * @brief Reads the configuration of a pin
+ *
+ * The configuration is answered from a copy in RAM, the configuration
+ * registers are not read. The callback, trigger, exti_flags and priority 
+ * are only set if the external interrupt line of the pin is connected to 
+ * the pin, set_priority is TRUE if priority has been read. output_speed 
+ * is never GPIOIF_SPEED_DEFAULT.
+ *
+ * @param  GPIOIf_pin_t pin         : Pin of which the configuration is read
+ * @param  GPIOIf_pin_config_t *cfg : Current configuration of the pin
+ * @return std_return_type_t status : If cfg is NULL the function returns
+ *                                    E_VALUE_NULL. If the pin does not exist
+ *                                    the function returns E_NOT_EXISTING.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t GPIOIf_get_pin_config(GPIOIf_pin_t pin, GPIOIf_pin_config_t *cfg);
+
 
 /**
  * @brief Set GPIO pin
@@ -151,9 +265,10 @@ std_return_type_t GPIOIf_pin_clear(GPIOIf_pin_t pin);
 /**
  * @brief Sets GPIO port to value
  *  
- * Sets a GPIO port to given value
+ * Sets a GPIO port to given value. All 16 pins of the port are updated
+ * at the same time.
  * 
- * @param  GPIOIf_pin_t port        : Which port shall be set
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
  * @param  uint16_t value           : Value to be set
  * @return std_return_type_t status : If the port is not available the 
  *                                    function returns E_NOT_EXISTING.
@@ -163,6 +278,73 @@ std_return_type_t GPIOIf_pin_clear(GPIOIf_pin_t pin);
  */
 std_return_type_t GPIOIf_port_set(GPIOIf_pin_t pin, uint16_t value);
 
+/**
+ * @brief Writes a value to the masked pins of a port
+ *  
+ * Sets the pins selected by mask to the corresponding bits of value. All 
+ * masked pins are updated at the same time, pins outside of mask keep their
+ * value.
+ * 
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @param  uint16_t mask            : Pins to be written
+ * @param  uint16_t value           : Value to be written
+ * @return std_return_type_t status : If the port is not available the 
+ *                                    function returns E_NOT_EXISTING.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t GPIOIf_port_write_masked(GPIOIf_pin_t port, uint16_t mask, uint16_t value);
+
+/**
+ * @brief Writes a buffer of words to the masked pins of a port
+ *  
+ * Writes the words of buffer one after another to the pins selected by 
+ * mask, e.g. to push data to a parallel bus. Each word is applied like 
+ * GPIOIf_port_write_masked(). Strobe signals have to be part of the 
+ * buffered words. The function returns after the last word was written.
+ * 
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @param  uint16_t mask            : Pins to be written
+ * @param  uint16_t *buffer         : Words to be written
+ * @param  size_t length            : Number of words in buffer
+ * @return std_return_type_t status : If the port is not available the 
+ *                                    function returns E_NOT_EXISTING. If
+ *                                    buffer is NULL the function returns
+ *                                    E_VALUE_NULL. Else it returns E_OK.
+ */
+std_return_type_t GPIOIf_port_write_stream(GPIOIf_pin_t port, uint16_t mask, 
+                                           const uint16_t *buffer, size_t length);
+
+/**
+ * @brief Sets and clears several pins of a port at once
+ *  
+ * Sets all pins in set_mask and clears all pins in clear_mask of the given
+ * port at the same time, i.e. without intermediate states on the port. Pins
+ * which are not part of either mask keep their value. If a pin is part of
+ * both masks, it is set.
+ * 
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @param  uint16_t set_mask        : Pins to be set
+ * @param  uint16_t clear_mask      : Pins to be cleared
+ * @return std_return_type_t status : If the port is not available the 
+ *                                    function returns E_NOT_EXISTING.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t GPIOIf_pins_write(GPIOIf_pin_t port, uint16_t set_mask, uint16_t clear_mask);
+
+/**
+ * @brief Toggles several pins of a port at once
+ *  
+ * Toggles all pins in mask of the given port at the same time. Pins which
+ * are not part of the mask keep their value.
+ * 
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @param  uint16_t mask            : Pins to be toggled
+ * @return std_return_type_t status : If the port is not available the 
+ *                                    function returns E_NOT_EXISTING.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t GPIOIf_pins_toggle(GPIOIf_pin_t port, uint16_t mask);
+
 /**
  * @brief Sets an analog value of a pin
  *  
@@ -221,4 +403,263 @@ boolean GPIOIf_pin_read(GPIOIf_pin_t pin);
  */
 std_return_type_t GPIOIf_port_read(GPIOIf_pin_t pin, uint16_t* buffer);
 
+/**
+ * @brief Reads the oldest timestamped edge of a pin
+ *  
+ * Takes the oldest edge event from the buffer of a pin which has been 
+ * configured with GPIOIF_EXTI_TIMESTAMP. The buffer is filled from the 
+ * interrupt and has to be read by one context only. If the buffer is full,
+ * new edges are dropped until events have been read.
+ * 
+ * @param  GPIOIf_pin_t pin         : Pin of which the event shall be read
+ * @param  GPIOIf_edge_event_t *event: Buffer for the event
+ * @return boolean status           : TRUE if an event was read, FALSE if no
+ *                                    event is available or the pin is not 
+ *                                    timestamped.
+ */
+boolean GPIOIf_get_edge_event(GPIOIf_pin_t pin, GPIOIf_edge_event_t *event);
+
+/**
+ * @brief Calls the callbacks of deferred edges
+ *  
+ * Calls the callbacks of all edges which have been queued by pins 
+ * configured with GPIOIF_EXTI_DEFERRED, in the order the edges occurred. 
+ * The function shall be called from one context only, e.g. the main loop.
+ * If the MCU calls it from its deferred work queue, it shall not be called
+ * by the application. If the queue is full, new edges are dropped until it
+ * has been processed.
+ * 
+ * @return uint32_t count           : Number of processed edges
+ */
+uint32_t GPIOIf_process_events(void);
+
+/**
+ * @brief Snapshot of all ports
+ */
+typedef struct __GPIOIf_snapshot
+{
+    uint16_t ports[8];                  // input values by port number, see GPIOIf_get_port_number(),
+                                        // 0 for ports which are not available or not initialized
+    uint32_t timestamp;                 // free running core clock cycle counter at the first read
+    uint32_t cycles;                    // core clock cycles between the first and the last read
+} GPIOIf_snapshot_t;
+
+/**
+ * @brief Reads all ports at once
+ *  
+ * Reads the inputs of all initialized ports back to back, i.e. the values 
+ * of different ports are sampled within a few clock cycles. The span of 
+ * the reads is reported in the snapshot.
+ * 
+ * @param  GPIOIf_snapshot_t *snapshot: Buffer for the snapshot
+ * @return std_return_type_t status : If snapshot is NULL the function 
+ *                                    returns E_VALUE_NULL. Else it returns
+ *                                    E_OK.
+ */
+std_return_type_t GPIOIf_snapshot(GPIOIf_snapshot_t *snapshot);
+
+/**
+ * @brief Word of a waveform
+ *
+ * Each word of a waveform sets the pins of the low half word and clears 
+ * the pins of the high half word of a port at the same time. Pins which are
+ * part of neither mask keep their value, a word of 0 changes nothing.
+ */
+#define GPIOIF_WAVEFORM_WORD(set_mask, clear_mask) \
+    ((((uint32_t) (uint16_t) (clear_mask)) << 16) | ((uint32_t) (uint16_t) (set_mask)))
+
+/**
+ * @brief Callback of a waveform
+ *
+ * Called from the interrupt context when a buffer has been output. In 
+ * double buffered mode the callback shall refill the given buffer and 
+ * return TRUE, or return FALSE if the waveform shall end after the buffer 
+ * which is output currently. At the end of the waveform the callback is 
+ * called once with buffer NULL, the return value is ignored.
+ */
+typedef boolean (*GPIOIf_waveform_callback_t)(uint32_t *buffer, size_t length);
+
+/**
+ * @brief Outputs a waveform on a port
+ *  
+ * Outputs the words of a buffer to the given port at a fixed rate without 
+ * CPU load, see GPIOIF_WAVEFORM_WORD(). If buffer_1 is NULL, buffer_0 is 
+ * output once. Else the buffers are output alternately and each buffer 
+ * is passed to the callback for refilling after it has been output, 
+ * i.e. sequences of arbitrary length can be generated. The pins have to be 
+ * configured as outputs. The function returns after the output was started.
+ * 
+ * @param  GPIOIf_pin_t port        : Port or any pin of the port
+ * @param  uint32_t rate            : Words per second
+ * @param  uint32_t *buffer_0       : First buffer
+ * @param  uint32_t *buffer_1       : Second buffer or NULL
+ * @param  size_t length            : Number of words per buffer
+ * @param  GPIOIf_waveform_callback_t callback: Callback, can be NULL if 
+ *                                    buffer_1 is NULL
+ * @return std_return_type_t status : If the port is not available the 
+ *                                    function returns E_NOT_EXISTING. If
+ *                                    buffer_0 is NULL or buffer_1 is used 
+ *                                    without callback the function returns
+ *                                    E_VALUE_NULL. If the rate or length is
+ *                                    not supported the function returns 
+ *                                    E_VALUE_OUT_OF_RANGE. If a waveform or
+ *                                    capture is running the function returns
+ *                                    E_STATE_ERR. Else it returns E_OK.
+ */
+std_return_type_t GPIOIf_waveform_start(GPIOIf_pin_t port, uint32_t rate, uint32_t *buffer_0,
+                                        uint32_t *buffer_1, size_t length, 
+                                        GPIOIf_waveform_callback_t callback);
+
+/**
+ * @brief Stops a waveform
+ *  
+ * Stops the output immediately, the pins keep their current value. The 
+ * callback is not called.
+ * 
+ * @return std_return_type_t status : If no waveform is running the function
+ *                                    returns E_STATE_NOINIT. Else it returns
+ *                                    E_OK.
+ */
+std_return_type_t GPIOIf_waveform_stop(void);
+
+/**
+ * @brief Output mode of a capture
+ *
+ * GPIOIF_CAPTURE_RAW : the samples are passed to the half/full callbacks
+ * GPIOIF_CAPTURE_RLE : the samples are compressed to runs of equal values
+ *                      and passed to the run callback
+ */
+typedef enum _GPIOIf_capture_mode
+{
+    GPIOIF_CAPTURE_RAW          = 0x00,
+    GPIOIF_CAPTURE_RLE          = 0x01,
+} GPIOIf_capture_mode_t;
+
+/**
+ * @brief Run of equal samples of a capture
+ */
+typedef struct __GPIOIf_capture_run
+{
+    uint16_t value;                     // masked port value
+    uint16_t length;                    // number of samples, runs longer than 0xFFFF are split
+} GPIOIf_capture_run_t;
+
+/**
+ * @brief Configuration of a capture
+ *
+ * The buffer is filled circularly, when the first (half) or second (full)
+ * half of the buffer has been filled, the corresponding callback is called 
+ * from the interrupt context while the other half is filled. The callback 
+ * has to process the samples before the half is overwritten. If the DMA
+ * reports a transfer error the capture is stopped and the error callback
+ * is called from the interrupt context with E_ERR.
+ */
+typedef struct __GPIOIf_capture_config
+{
+    GPIOIf_pin_t port;                  // port or any pin of the port
+    uint32_t rate;                      // samples per second
+    uint16_t *buffer;                   // sample buffer
+    size_t length;                      // number of samples of buffer, even
+    uint16_t mask;                      // pins which are compared in RLE mode
+    GPIOIf_capture_mode_t mode;
+    void (*half_callback)(const uint16_t *samples, size_t count);  // first half filled (RAW)
+    void (*full_callback)(const uint16_t *samples, size_t count);  // second half filled (RAW)
+    GPIOIf_capture_run_t *runs;         // run buffer (RLE)
+    size_t runs_length;                 // number of runs of the run buffer (RLE)
+    void (*run_callback)(const GPIOIf_capture_run_t *runs, size_t count);  // runs completed (RLE)
+    void (*error_callback)(std_return_type_t status);                      // capture stopped by an error, may be NULL
+} GPIOIf_capture_config_t;
+
+/**
+ * @brief Starts a capture of a port
+ *  
+ * Samples the input register of a port at a fixed rate into a circular
+ * double buffer without CPU load. The capture runs until it is stopped.
+ * 
+ * @param  GPIOIf_capture_config_t *cfg: Capture configuration
+ * @return std_return_type_t status : If cfg, the buffer or a callback of
+ *                                    the mode is NULL the function returns
+ *                                    E_VALUE_NULL. If the port is not 
+ *                                    available the function returns 
+ *                                    E_NOT_EXISTING. If the rate or length 
+ *                                    is not supported the function returns
+ *                                    E_VALUE_OUT_OF_RANGE. If a waveform or
+ *                                    capture is running the function 
+ *                                    returns E_STATE_ERR. Else it returns 
+ *                                    E_OK.
+ */
+std_return_type_t GPIOIf_capture_start(const GPIOIf_capture_config_t *cfg);
+
+/**
+ * @brief Stops a capture
+ *  
+ * Stops the sampling immediately. In RLE mode the samples taken since the
+ * last half was completed are compressed and all runs including the 
+ * current one are passed to the run callback. In RAW mode the samples of 
+ * the partially filled half are dropped.
+ * 
+ * @return std_return_type_t status : If no capture is running the function
+ *                                    returns E_STATE_NOINIT. Else it returns
+ *                                    E_OK.
+ */
+std_return_type_t GPIOIf_capture_stop(void);
+
+/**
+ * @brief Registers a software signal
+ *
+ * A software signal is an external interrupt line which is not connected
+ * to a pin and which is only raised by software. GPIOIf_signal_raise() 
+ * raises it from any context with a single store and the handler runs in 
+ * the interrupt of the line, i.e. it preempts all code of lower priority.
+ * This allows prioritised deferred work without an operating system. The
+ * lines which can be used as signal depend on the MCU, see the MCU 
+ * specific header. Lines which are shared with pins can only be used if
+ * no pin uses the line. If the interrupt is shared with other lines, the
+ * priority applies to all of them.
+ * 
+ * @param  uint8_t signal           : External interrupt line of the signal
+ * @param  void (*handler)(void)    : Function called for each raise
+ * @param  uint8_t priority         : Interrupt priority of the line, 0 is
+ *                                    the highest priority
+ * @return std_return_type_t status : If the line can not be used as signal
+ *                                    the function returns E_NOT_EXISTING. If
+ *                                    handler is NULL the function returns
+ *                                    E_VALUE_NULL. If a pin uses the line the
+ *                                    function returns E_STATE_ERR. If the 
+ *                                    priority is not supported the function
+ *                                    returns E_VALUE_OUT_OF_RANGE. Else it
+ *                                    returns E_OK.
+ */
+std_return_type_t GPIOIf_signal_register(uint8_t signal, void (*handler)(void), uint8_t priority);
+
+/**
+ * @brief Unregisters a software signal
+ *
+ * A pending raise of the signal is discarded.
+ * 
+ * @param  uint8_t signal           : External interrupt line of the signal
+ * @return std_return_type_t status : If the line is not registered as 
+ *                                    signal the function returns 
+ *                                    E_STATE_NOINIT. Else it returns E_OK.
+ */
+std_return_type_t GPIOIf_signal_unregister(uint8_t signal);
+
+/**
+ * @brief Inline fast path
+ *  
+ * The MCU specific header provides the type GPIOIf_handle_t, the macros
+ * GPIOIF_HANDLE(pin)/GPIOIF_HANDLE_INIT(pin), which resolve a pin at 
+ * compile time, and the inline functions GPIOIf_handle_set(), 
+ * GPIOIf_handle_clear(), GPIOIf_handle_toggle() and GPIOIf_handle_read().
+ * It also provides GPIOIf_signal_raise(), which raises a registered
+ * software signal, and GPIOIf_wait_for_event(), which sleeps until the 
+ * next wakeup event, e.g. of a pin configured with GPIOIF_EXTI_EVENT.
+ * Handles are not validated, they shall only be created from pins which
+ * have been configured successfully with GPIOIf_config_pin().
+ */
+#include <mcus.h>
+#if IS_MCU_FAMILY(MCU_STM32F4)
+    #include <stm32/stm32f4xx/stm32f4xx_GPIOIf.h>
+#endif
+
 #endif
\ No newline at end of file
@@ -117,6 +117,9 @@ typedef struct _I2CIf_handle
     I2CIf_slave_cfg_t *slave_cfg;                               // configuration if devices operates as slave
     I2CIf_device_mode_t device_mode;                            // in which mode the MCU shall eact
     I2CIf_address_mode_t addr_mode;                             // address mode of I2C bus
+    uint8_t priority;                                           // interrupt priority of the bus, 0 is the highest priority, the MCU
+                                                                // rejects priorities which its critical sections can not mask
+    boolean set_priority;                                       // TRUE applies priority, FALSE keeps the current priority
 } I2CIf_handle_t;
 
 
@@ -155,8 +158,9 @@ std_return_type_t I2CIf_deinit(identifier_t i2c_bus_id);
  * @return std_return_type_t status : If the bus id does not exist on the host
  *                                    the function returns E_NOT_EXISTING. If
  *                                    prescaler if the prescaler value is no
- *                                    supported or the scl frequency is out of range,
- *                                    the function returns E_VALUE_OUT_OF_RANGE.
+ *                                    supported, the scl frequency or the
+ *                                    priority is out of range, the function
+ *                                    returns E_VALUE_OUT_OF_RANGE.
  *                                    If one of the device modes or duty cycle is 
  *                                    not supported the function returns E_NOT_SUPPORTED. 
  *                                    Else it returns E_OK.
@@ -0,0 +1,165 @@
+/**
+ * @file OneWireIf.h
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief File containing API for a 1-Wire bus master
+ *
+ * This file specifies a generic API which shall be used to
+ * communicate with 1-Wire devices (e.g. temperature sensors) on
+ * an open-drain GPIO with external pullup. The reset, write and
+ * read slots are timed by a hardware timer, the line is driven
+ * and sampled in the timer interrupt. Transactions run in the
+ * background and report their result with a callback.
+ */
+
+#ifndef ONEWIREIF_H
+#define ONEWIREIF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+
+// 1-Wire ROM commands
+#define ONEWIREIF_CMD_READ_ROM      0x33
+#define ONEWIREIF_CMD_MATCH_ROM     0x55
+#define ONEWIREIF_CMD_SKIP_ROM      0xCC
+#define ONEWIREIF_CMD_SEARCH_ROM    0xF0
+
+/**
+ * @brief Completion callback of a transaction
+ *
+ * Is called at the lowest interrupt priority after the transaction has
+ * finished, never from the interrupt of the bus. If the deferred work 
+ * queue of the MCU is full the call is dropped, OneWireIf_busy() still
+ * reports the end of the transaction. A new transaction may be started
+ * from the callback.
+ *
+ * @param  std_return_type_t status : Result of the transaction, see
+ *                                    OneWireIf_transfer() and
+ *                                    OneWireIf_search()
+ */
+typedef void (*OneWireIf_callback_t)(std_return_type_t status);
+
+typedef struct _OneWireIf_config
+{
+    GPIOIf_pin_t pin;                                           // data pin of the bus
+    uint8_t priority;                                           // interrupt priority of the slot timer, 0 is the highest priority
+    boolean set_priority;                                       // TRUE applies priority, FALSE keeps the current priority
+} OneWireIf_config_t;
+
+/**
+ * @brief Initializes the 1-Wire master
+ *
+ * Configures the pin as open-drain output, releases the line and starts
+ * the timer of the bus. The port of the pin has to be initialized with
+ * GPIOIf_init(). A slot whose timing is broken by a late timer interrupt
+ * aborts the transaction with E_ERR, a priority which keeps the timer
+ * interrupt from being delayed by other interrupts avoids this.
+ *
+ * @param  OneWireIf_config_t *cfg  : Configuration of the bus
+ * @return std_return_type_t status : If cfg is NULL the function returns
+ *                                    E_VALUE_NULL. If the master is already
+ *                                    initialized the function returns
+ *                                    E_STATE_INIT. If set_priority is TRUE
+ *                                    and the priority is not supported the
+ *                                    function returns E_VALUE_OUT_OF_RANGE.
+ *                                    If the pin does not exist the function
+ *                                    returns E_NOT_EXISTING. If the timer
+ *                                    can not count microseconds the
+ *                                    function returns E_NOT_SUPPORTED. Else
+ *                                    it returns the status of
+ *                                    GPIOIf_config_pin().
+ */
+std_return_type_t OneWireIf_init(const OneWireIf_config_t *cfg);
+
+/**
+ * @brief Deinitializes the 1-Wire master
+ *
+ * A running transaction is aborted without calling its callback, the
+ * line is released.
+ *
+ * @return std_return_type_t status : If the master is not initialized the
+ *                                    function returns E_STATE_NOINIT. Else
+ *                                    it returns E_OK.
+ */
+std_return_type_t OneWireIf_deinit(void);
+
+/**
+ * @brief Starts a transaction
+ *
+ * Sends a reset pulse, writes tx_length bytes and reads rx_length bytes
+ * afterwards, bytes are transferred least significant bit first. The
+ * buffers have to stay valid until the callback is called.
+ *
+ * @param  uint8_t *tx              : Bytes to be written, e.g. ROM and
+ *                                    function command
+ * @param  size_t tx_length         : Number of bytes to be written
+ * @param  uint8_t *rx              : Buffer for the bytes read
+ * @param  size_t rx_length         : Number of bytes to be read
+ * @param  OneWireIf_callback_t callback : Called when the transaction has
+ *                                    finished with E_OK, with
+ *                                    E_NOT_EXISTING if no device answered
+ *                                    the reset pulse or with E_ERR if the
+ *                                    timing of a slot was missed. May be
+ *                                    NULL.
+ * @return std_return_type_t status : If a buffer with non-zero length is
+ *                                    NULL the function returns E_VALUE_NULL.
+ *                                    If a transaction is running the
+ *                                    function returns E_STATE_ERR. If the
+ *                                    master is not initialized the function
+ *                                    returns E_STATE_NOINIT. Else it returns
+ *                                    E_OK.
+ */
+std_return_type_t OneWireIf_transfer(const uint8_t *tx, size_t tx_length, uint8_t *rx, size_t rx_length,
+                                     OneWireIf_callback_t callback);
+
+/**
+ * @brief Starts a search for the ROM codes of all devices on the bus
+ *
+ * Runs the complete ROM search, i.e. one search pass per device. The
+ * ROM codes are stored with the family code in the lowest byte. The
+ * buffers have to stay valid until the callback is called.
+ *
+ * @param  uint64_t *roms           : Buffer for the ROM codes found
+ * @param  size_t length            : Number of ROM codes which fit in roms,
+ *                                    the search stops when it is full
+ * @param  size_t *found            : Number of ROM codes found, valid when
+ *                                    the callback is called
+ * @param  OneWireIf_callback_t callback : Called when the search has
+ *                                    finished with E_OK, with
+ *                                    E_NOT_EXISTING if no device is on the
+ *                                    bus or with E_ERR if a ROM code had a
+ *                                    CRC error or the timing of a slot was
+ *                                    missed. May be NULL.
+ * @return std_return_type_t status : If roms or found is NULL the function
+ *                                    returns E_VALUE_NULL. If length is 0
+ *                                    the function returns
+ *                                    E_VALUE_OUT_OF_RANGE. If a transaction
+ *                                    is running the function returns
+ *                                    E_STATE_ERR. If the master is not
+ *                                    initialized the function returns
+ *                                    E_STATE_NOINIT. Else it returns E_OK.
+ */
+std_return_type_t OneWireIf_search(uint64_t *roms, size_t length, size_t *found,
+                                   OneWireIf_callback_t callback);
+
+/**
+ * @brief Checks if a transaction is running
+ *
+ * @return boolean busy             : TRUE while a transaction is running
+ */
+boolean OneWireIf_busy(void);
+
+/**
+ * @brief Calculates the 1-Wire CRC8 of data
+ *
+ * The CRC of a ROM code or a scratchpad including its CRC byte is 0.
+ *
+ * @param  uint8_t *data            : Data of which the CRC is calculated
+ * @param  size_t length            : Number of bytes
+ * @return uint8_t crc              : CRC8 with polynomial x^8 + x^5 + x^4 + 1
+ */
+uint8_t OneWireIf_crc8(const uint8_t *data, size_t length);
+
+#endif
@@ -97,6 +97,9 @@ typedef struct _RTCIf_alarm_handle
     RTCIf_date_time_t *alarm;               // time when the alarm shall rang
     RTCIf_date_time_t *buffer;              // buffer for the timestamp of the callback function
     RTCIf_Alarm_flags_t flags;              // flags of the alarm
+    uint8_t priority;                       // interrupt priority of the alarms, 0 is the highest priority, the MCU
+                                            // rejects priorities which its critical sections can not mask
+    boolean set_priority;                   // TRUE applies priority, FALSE keeps the current priority
 } RTCIf_alarm_handle_t;
 
 /**
@@ -204,8 +207,9 @@ std_return_type_t RTCIf_get_date_time(RTCIf_date_time_t *date_time);
  *                                        If the provided callback function
  *                                        is NULL the function returns
  *                                        E_VALUE_NULL. If one of the date/time 
- *                                        values is out of range the function  
- *                                        returns E_VALUE_OUT_OF_RANGE Else it 
+ *                                        values or the priority is out of 
+ *                                        range the function returns 
+ *                                        E_VALUE_OUT_OF_RANGE Else it 
  *                                        returns E_OK.
  */
 std_return_type_t RTCIf_set_alarm(identifier_t alarm_id, RTCIf_alarm_handle_t *alarm);
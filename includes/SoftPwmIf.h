@@ -0,0 +1,89 @@
+/**
+ * @file SoftPwmIf.h
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief File containing API for software PWM on GPIO's
+ *
+ * This file specifies a generic API which shall be used to
+ * generate PWM signals on any output pin, e.g. for dimming of
+ * LEDs or servos. All channels share one period and are driven
+ * from a single timer interrupt, which only executes the
+ * precomputed switching events of the period.
+ */
+
+#ifndef SOFTPWMIF_H
+#define SOFTPWMIF_H
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+
+/**
+ * @brief Initializes the software PWM
+ *
+ * Starts the timer of the software PWM. All channels use the same period
+ * and start their high phase at the beginning of the period. Each period
+ * is divided in resolution steps, the length of a step shall not be
+ * shorter than the interrupt latency.
+ *
+ * @param  uint32_t frequency       : PWM frequency in Hz
+ * @param  uint16_t resolution      : Steps per period, duty cycles range
+ *                                    from 0 to resolution
+ * @return std_return_type_t status : If frequency * resolution can not be
+ *                                    generated by the timer the function
+ *                                    returns E_VALUE_OUT_OF_RANGE. If the
+ *                                    software PWM is already initialized
+ *                                    the function returns E_STATE_INIT.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t SoftPwmIf_init(uint32_t frequency, uint16_t resolution);
+
+/**
+ * @brief Deinitializes the software PWM
+ *
+ * Stops the timer and removes all channels, the pins keep their current
+ * value.
+ *
+ * @return std_return_type_t status : If the software PWM is not initialized
+ *                                    the function returns E_STATE_NOINIT.
+ *                                    Else it returns E_OK.
+ */
+std_return_type_t SoftPwmIf_deinit(void);
+
+/**
+ * @brief Sets the duty cycle of a pin
+ *
+ * Adds the pin as channel if it is not used yet. The pin has to be
+ * configured as output. The new duty cycle is applied at the beginning of
+ * the next period.
+ *
+ * @param  GPIOIf_pin_t pin         : Pin of the channel
+ * @param  uint16_t duty            : High steps per period, 0 keeps the pin
+ *                                    low, resolution keeps it high
+ * @return std_return_type_t status : If the pin does not exist the function
+ *                                    returns E_NOT_EXISTING. If duty is
+ *                                    larger than the resolution the function
+ *                                    returns E_VALUE_OUT_OF_RANGE. If no
+ *                                    channel is available the function
+ *                                    returns E_NOT_SUPPORTED. If the software
+ *                                    PWM is not initialized the function
+ *                                    returns E_STATE_NOINIT. Else it returns
+ *                                    E_OK.
+ */
+std_return_type_t SoftPwmIf_set_duty(GPIOIf_pin_t pin, uint16_t duty);
+
+/**
+ * @brief Removes a pin from the software PWM
+ *
+ * The pin keeps the value it has at the end of the current period.
+ *
+ * @param  GPIOIf_pin_t pin         : Pin of the channel
+ * @return std_return_type_t status : If the pin is not a channel the
+ *                                    function returns E_NOT_EXISTING. If the
+ *                                    software PWM is not initialized the
+ *                                    function returns E_STATE_NOINIT. Else
+ *                                    it returns E_OK.
+ */
+std_return_type_t SoftPwmIf_remove_pin(GPIOIf_pin_t pin);
+
+#endif
@@ -7,6 +7,40 @@
 #define _MMIO_HWORD(mem_addr) (*(volatile uint16_t *)(mem_addr))
 #define _MMIO_WORD(mem_addr) (*(volatile uint32_t *)(mem_addr))
 
+#define STM32F4xx_ALWAYS_INLINE     static inline __attribute__((always_inline))
+
+// data and instruction synchronization barriers
+#define STM32F4xx_DSB()             __asm volatile ("dsb 0xF" ::: "memory")
+#define STM32F4xx_ISB()             __asm volatile ("isb 0xF" ::: "memory")
+
+// functions in SRAM execute without flash wait states. The section is 
+// matched by *(.data*) of the linker script, i.e. the code is copied with 
+// the initial values of the variables by Reset_Handler. Calls from flash 
+// exceed the range of a BL instruction.
+#define STM32F4xx_RAMFUNC           __attribute__((section(".data.ramfunc"), noinline, long_call))
+
+// Cortex M4 bit-band regions, each bit of the first MB of SRAM and of the
+// peripherals is mapped to a word of the alias region. Writing 0/1 to the
+// alias word clears/sets the bit with a single, non interruptible store.
+// Do not use on write-1-to-clear flags (e.g. EXTI_PR), the internal
+// read-modify-write would clear all other pending flags as well.
+
+#define _BITBAND_ADDR_SRAM          0x20000000UL
+#define _BITBAND_ADDR_SRAM_ALIAS    0x22000000UL
+#define _BITBAND_ADDR_PERIPH        0x40000000UL
+#define _BITBAND_ADDR_PERIPH_ALIAS  0x42000000UL
+
+#define _BITBAND_ALIAS(alias_addr, region_addr, mem_addr, bit) \
+    ((alias_addr) + ((((uint32_t)(uintptr_t)(mem_addr)) - (region_addr)) << 5) + (((uint32_t)(bit)) << 2))
+
+#define _MMIO_BITBAND(mem_addr, bit) _MMIO_WORD(_BITBAND_ALIAS(_BITBAND_ADDR_PERIPH_ALIAS, _BITBAND_ADDR_PERIPH, mem_addr, bit))
+#define _SRAM_BITBAND(mem_addr, bit) _MMIO_WORD(_BITBAND_ALIAS(_BITBAND_ADDR_SRAM_ALIAS, _BITBAND_ADDR_SRAM, mem_addr, bit))
+
+// single bit of a peripheral register, e.g. STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_IMR, 3) = 1;
+#define STM32F4xx_BITBAND(reg, bit)      _MMIO_BITBAND(&(reg), bit)
+// single bit of a variable in SRAM, e.g. STM32F4xx_SRAM_BITBAND(flags, 3) = 1;
+#define STM32F4xx_SRAM_BITBAND(var, bit) _SRAM_BITBAND(&(var), bit)
+
 // Cortex M4 general registers
 
 #define _MMIO_ADDR_NVIC     0xE000E100UL
@@ -30,6 +64,69 @@ typedef struct
 
 #define STM32F4xx_NVIC           ((STM32F4xx_NVIC_RegDef_t* ) _MMIO_ADDR_NVIC)
 
+#define _MMIO_ADDR_DWT      0xE0001000UL
+#define _MMIO_ADDR_DCB      0xE000EDF0UL
+
+typedef struct 
+{
+    volatile uint32_t DWT_CTRL;         //  0x0000 Control Register 0xE0001000
+    volatile uint32_t DWT_CYCCNT;       //  0x0004 Cycle Count Register 0xE0001004
+    volatile uint32_t DWT_CPICNT;       //  0x0008 CPI Count Register 0xE0001008
+    volatile uint32_t DWT_EXCCNT;       //  0x000C Exception Overhead Count Register 0xE000100C
+    volatile uint32_t DWT_SLEEPCNT;     //  0x0010 Sleep Count Register 0xE0001010
+    volatile uint32_t DWT_LSUCNT;       //  0x0014 LSU Count Register 0xE0001014
+    volatile uint32_t DWT_FOLDCNT;      //  0x0018 Folded-instruction Count Register 0xE0001018
+    const uint32_t DWT_PCSR;            //  0x001C Program Counter Sample Register 0xE000101C
+} STM32F4xx_DWT_RegDef_t;
+
+typedef struct 
+{
+    volatile uint32_t DCB_DHCSR;        //  0x0000 Debug Halting Control and Status Register 0xE000EDF0
+    volatile uint32_t DCB_DCRSR;        //  0x0004 Debug Core Register Selector Register 0xE000EDF4
+    volatile uint32_t DCB_DCRDR;        //  0x0008 Debug Core Register Data Register 0xE000EDF8
+    volatile uint32_t DCB_DEMCR;        //  0x000C Debug Exception and Monitor Control Register 0xE000EDFC
+} STM32F4xx_DCB_RegDef_t;
+
+#define STM32F4xx_DWT            ((STM32F4xx_DWT_RegDef_t* ) _MMIO_ADDR_DWT)
+#define STM32F4xx_DCB            ((STM32F4xx_DCB_RegDef_t* ) _MMIO_ADDR_DCB)
+
+#define _MMIO_ADDR_SCB      0xE000ED00UL
+
+typedef struct 
+{
+    const uint32_t SCB_CPUID;           //  0x0000 CPUID Base Register 0xE000ED00
+    volatile uint32_t SCB_ICSR;         //  0x0004 Interrupt Control and State Register 0xE000ED04
+    volatile uint32_t SCB_VTOR;         //  0x0008 Vector Table Offset Register 0xE000ED08
+    volatile uint32_t SCB_AIRCR;        //  0x000C Application Interrupt and Reset Control Register 0xE000ED0C
+    volatile uint32_t SCB_SCR;          //  0x0010 System Control Register 0xE000ED10
+    volatile uint32_t SCB_CCR;          //  0x0014 Configuration and Control Register 0xE000ED14
+    volatile uint32_t SCB_SHPR[3];      //  0x0018 - 0x0020 System Handler Priority Registers 0xE000ED18
+    volatile uint32_t SCB_SHCSR;        //  0x0024 System Handler Control and State Register 0xE000ED24
+} STM32F4xx_SCB_RegDef_t;
+
+#define STM32F4xx_SCB            ((STM32F4xx_SCB_RegDef_t* ) _MMIO_ADDR_SCB)
+
+// AIRCR is only written together with its key
+#define STM32F4xx_SCB_AIRCR_VECTKEY         (0x05FAUL << 16)
+#define STM32F4xx_SCB_AIRCR_VECTKEY_MASK    (0xFFFFUL << 16)
+#define STM32F4xx_SCB_AIRCR_PRIGROUP_POS    8
+#define STM32F4xx_SCB_AIRCR_PRIGROUP_MASK   (0x7UL << STM32F4xx_SCB_AIRCR_PRIGROUP_POS)
+
+// writing 0 to the other bits of ICSR has no effect
+#define STM32F4xx_SCB_ICSR_PENDSVSET        (0x1UL << 28)
+#define STM32F4xx_SCB_SHPR3_PENDSV_POS      16
+
+#define STM32F4xx_DCB_DEMCR_TRCENA      (0x1UL << 24)
+#define STM32F4xx_DWT_CTRL_CYCCNTENA    (0x1UL << 0)
+
+// enables the free running cycle counter DWT_CYCCNT (core clock),
+// the DWT is part of the debug block and has to be enabled by TRCENA first
+#define STM32F4xx_CYCCNT_ENABLE()   do { \
+        STM32F4xx_DCB->DCB_DEMCR |= STM32F4xx_DCB_DEMCR_TRCENA; \
+        STM32F4xx_DWT->DWT_CTRL  |= STM32F4xx_DWT_CTRL_CYCCNTENA; \
+    } while(0)
+#define STM32F4xx_CYCCNT()          (STM32F4xx_DWT->DWT_CYCCNT)
+
 
 // STM32F4xx peripheral registers
 
@@ -663,108 +760,108 @@ typedef struct
 
 #define STM32F4xx_RCC                ((STM32F4xx_RCC_RegDef_t* ) _MMIO_ADDR_RCC)
 
-#define STM32F4xx_GPIOA_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOAEN = 1)
-#define STM32F4xx_GPIOA_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOAEN = 0)
-#define STM32F4xx_GPIOB_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOBEN = 1)
-#define STM32F4xx_GPIOB_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOBEN = 0)
-#define STM32F4xx_GPIOC_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOCEN = 1)
-#define STM32F4xx_GPIOC_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOCEN = 0)
-#define STM32F4xx_GPIOD_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIODEN = 1)
-#define STM32F4xx_GPIOD_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIODEN = 0)
-#define STM32F4xx_GPIOE_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOEEN = 1)
-#define STM32F4xx_GPIOE_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOEEN = 0)
-#define STM32F4xx_GPIOF_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOFEN = 1)
-#define STM32F4xx_GPIOF_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOFEN = 0)
-#define STM32F4xx_GPIOG_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOGEN = 1)
-#define STM32F4xx_GPIOG_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOGEN = 0)
-#define STM32F4xx_GPIOH_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOHEN = 1)
-#define STM32F4xx_GPIOH_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOHEN = 0)
-#define STM32F4xx_GPIOI_PCLK_EN()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOIEN = 1)
-#define STM32F4xx_GPIOI_PCLK_DI()    (STM32F4xx_RCC->RCC_AHB1ENR.GPIOIEN = 0)
-
-#define STM32F4xx_CRC_PCLK_EN()      (STM32F4xx_RCC->RCC_AHB1ENR.CRCEN = 1)
-#define STM32F4xx_CRC_PCLK_DI()      (STM32F4xx_RCC->RCC_AHB1ENR.CRCEN = 0)
-
-#define STM32F4xx_DMA1_PCLK_EN()     (STM32F4xx_RCC->RCC_AHB1ENR.DMA1EN = 1)
-#define STM32F4xx_DMA1_PCLK_DI()     (STM32F4xx_RCC->RCC_AHB1ENR.DMA1EN = 0)
-#define STM32F4xx_DMA2_PCLK_EN()     (STM32F4xx_RCC->RCC_AHB1ENR.DMA2EN = 1)
-#define STM32F4xx_DMA2_PCLK_DI()     (STM32F4xx_RCC->RCC_AHB1ENR.DMA2EN = 0)
-
-#define STM32F4xx_USB_FS_PCLK_EN()   (STM32F4xx_RCC->RCC_AHB2ENR.OTGFSEN = 1)
-#define STM32F4xx_USB_FS_PCLK_DI()   (STM32F4xx_RCC->RCC_AHB2ENR.OTGFSEN = 0)
-
-#define STM32F4xx_TIM1_PCLK_EN()     (STM32F4xx_RCC->RCC_APB2ENR.TIM1EN  = 1)
-#define STM32F4xx_TIM1_PCLK_DI()     (STM32F4xx_RCC->RCC_APB2ENR.TIM1EN  = 0)
-#define STM32F4xx_TIM2_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.TIM2EN  = 1)
-#define STM32F4xx_TIM2_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.TIM2EN  = 0)
-#define STM32F4xx_TIM3_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.TIM3EN  = 1)
-#define STM32F4xx_TIM3_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.TIM3EN  = 0)
-#define STM32F4xx_TIM4_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.TIM4EN  = 1)
-#define STM32F4xx_TIM4_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.TIM4EN  = 0)
-#define STM32F4xx_TIM5_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.TIM5EN  = 1)
-#define STM32F4xx_TIM5_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.TIM5EN  = 0)
-#define STM32F4xx_TIM6_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.TIM6EN  = 1)
-#define STM32F4xx_TIM6_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.TIM6EN  = 0)
-#define STM32F4xx_TIM7_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.TIM7EN  = 1)
-#define STM32F4xx_TIM7_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.TIM7EN  = 0)
-#define STM32F4xx_TIM8_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.TIM8EN  = 1)
-#define STM32F4xx_TIM8_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.TIM8EN  = 0)
-#define STM32F4xx_TIM9_PCLK_EN()     (STM32F4xx_RCC->RCC_APB2ENR.TIM9EN  = 1)
-#define STM32F4xx_TIM9_PCLK_DI()     (STM32F4xx_RCC->RCC_APB2ENR.TIM9EN  = 0)
-#define STM32F4xx_TIM10_PCLK_EN()    (STM32F4xx_RCC->RCC_APB2ENR.TIM10EN = 1)
-#define STM32F4xx_TIM10_PCLK_DI()    (STM32F4xx_RCC->RCC_APB2ENR.TIM10EN = 0)
-#define STM32F4xx_TIM11_PCLK_EN()    (STM32F4xx_RCC->RCC_APB2ENR.TIM11EN = 1)
-#define STM32F4xx_TIM11_PCLK_DI()    (STM32F4xx_RCC->RCC_APB2ENR.TIM11EN = 0)
-#define STM32F4xx_TIM12_PCLK_EN()    (STM32F4xx_RCC->RCC_APB1ENR.TIM12EN = 1)
-#define STM32F4xx_TIM12_PCLK_DI()    (STM32F4xx_RCC->RCC_APB1ENR.TIM12EN = 0)
-#define STM32F4xx_TIM13_PCLK_EN()    (STM32F4xx_RCC->RCC_APB1ENR.TIM13EN = 1)
-#define STM32F4xx_TIM13_PCLK_DI()    (STM32F4xx_RCC->RCC_APB1ENR.TIM13EN = 0)
-
-#define STM32F4xx_WWDG_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.WWDGEN = 1)
-#define STM32F4xx_WWDG_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.WWDGEN = 0)
-
-#define STM32F4xx_PWR_PCLK_EN()      (STM32F4xx_RCC->RCC_APB1ENR.PWREN = 1)
-#define STM32F4xx_PWR_PCLK_DI()      (STM32F4xx_RCC->RCC_APB1ENR.PWREN = 0)
-
-#define STM32F4xx_I2C1_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.I2C1EN = 1)
-#define STM32F4xx_I2C1_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.I2C1EN = 0)
-#define STM32F4xx_I2C2_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.I2C2EN = 1)
-#define STM32F4xx_I2C2_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.I2C2EN = 0)
-#define STM32F4xx_I2C3_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.I2C3EN = 1)
-#define STM32F4xx_I2C3_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.I2C3EN = 0)
-
-#define STM32F4xx_SPI1_PCLK_EN()     (STM32F4xx_RCC->RCC_APB2ENR.SPI1EN = 1)
-#define STM32F4xx_SPI1_PCLK_DI()     (STM32F4xx_RCC->RCC_APB2ENR.SPI1EN = 0)
-#define STM32F4xx_SPI2_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.SPI2EN = 1)
-#define STM32F4xx_SPI2_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.SPI2EN = 0)
-#define STM32F4xx_SPI3_PCLK_EN()     (STM32F4xx_RCC->RCC_APB1ENR.SPI4EN = 1)
-#define STM32F4xx_SPI3_PCLK_DI()     (STM32F4xx_RCC->RCC_APB1ENR.SPI4EN = 0)
-#define STM32F4xx_SPI4_PCLK_EN()     (STM32F4xx_RCC->RCC_APB2ENR.SPI4EN = 1)
-#define STM32F4xx_SPI4_PCLK_DI()     (STM32F4xx_RCC->RCC_APB2ENR.SPI4EN = 0)
-#define STM32F4xx_SPI5_PCLK_EN()     (STM32F4xx_RCC->RCC_APB2ENR.SPI5EN = 1)
-#define STM32F4xx_SPI5_PCLK_DI()     (STM32F4xx_RCC->RCC_APB2ENR.SPI5EN = 0)
-
-#define STM32F4xx_USART1_PCLK_EN()   (STM32F4xx_RCC->RCC_APB2ENR.UART1EN = 1)
-#define STM32F4xx_USART1_PCLK_DI()   (STM32F4xx_RCC->RCC_APB2ENR.UART1EN = 0)
-#define STM32F4xx_USART2_PCLK_EN()   (STM32F4xx_RCC->RCC_APB1ENR.UART2EN = 1)
-#define STM32F4xx_USART2_PCLK_DI()   (STM32F4xx_RCC->RCC_APB1ENR.UART2EN = 0)
-#define STM32F4xx_USART3_PCLK_EN()   (STM32F4xx_RCC->RCC_APB1ENR.UART3EN = 1)
-#define STM32F4xx_USART3_PCLK_DI()   (STM32F4xx_RCC->RCC_APB1ENR.UART3EN = 0)
-#define STM32F4xx_USART4_PCLK_EN()   (STM32F4xx_RCC->RCC_APB1ENR.UART4EN = 1)
-#define STM32F4xx_USART4_PCLK_DI()   (STM32F4xx_RCC->RCC_APB1ENR.UART4EN = 0)
-#define STM32F4xx_USART5_PCLK_EN()   (STM32F4xx_RCC->RCC_APB1ENR.UART5EN = 1)
-#define STM32F4xx_USART5_PCLK_DI()   (STM32F4xx_RCC->RCC_APB1ENR.UART5EN = 0)
-#define STM32F4xx_USART6_PCLK_EN()   (STM32F4xx_RCC->RCC_APB2ENR.UART6EN = 1)
-#define STM32F4xx_USART6_PCLK_DI()   (STM32F4xx_RCC->RCC_APB2ENR.UART6EN = 0)
-
-#define STM32F4xx_ADC1_PCLK_EN()     (STM32F4xx_RCC->RCC_APB2ENR.ADCEN = 1)
-#define STM32F4xx_ADC1_PCLK_DI()     (STM32F4xx_RCC->RCC_APB2ENR.ADCEN = 0)
-
-#define STM32F4xx_SDIO_PCLK_EN()     (STM32F4xx_RCC->RCC_APB2ENR.SDIOEN = 1)
-#define STM32F4xx_SDIO_PCLK_DI()     (STM32F4xx_RCC->RCC_APB2ENR.SDIOEN = 0)
-
-#define STM32F4xx_SYSCFG_PCLK_EN()   (STM32F4xx_RCC->RCC_APB2ENR.SYSCFGEN = 1)
-#define STM32F4xx_SYSCFG_PCLK_DI()   (STM32F4xx_RCC->RCC_APB2ENR.SYSCFGEN = 0)
+#define STM32F4xx_GPIOA_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  0) = 1)
+#define STM32F4xx_GPIOA_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  0) = 0)
+#define STM32F4xx_GPIOB_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  1) = 1)
+#define STM32F4xx_GPIOB_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  1) = 0)
+#define STM32F4xx_GPIOC_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  2) = 1)
+#define STM32F4xx_GPIOC_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  2) = 0)
+#define STM32F4xx_GPIOD_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  3) = 1)
+#define STM32F4xx_GPIOD_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  3) = 0)
+#define STM32F4xx_GPIOE_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  4) = 1)
+#define STM32F4xx_GPIOE_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  4) = 0)
+#define STM32F4xx_GPIOF_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  5) = 1)
+#define STM32F4xx_GPIOF_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  5) = 0)
+#define STM32F4xx_GPIOG_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  6) = 1)
+#define STM32F4xx_GPIOG_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  6) = 0)
+#define STM32F4xx_GPIOH_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  7) = 1)
+#define STM32F4xx_GPIOH_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  7) = 0)
+#define STM32F4xx_GPIOI_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  8) = 1)
+#define STM32F4xx_GPIOI_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR,  8) = 0)
+
+#define STM32F4xx_CRC_PCLK_EN()      (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR, 12) = 1)
+#define STM32F4xx_CRC_PCLK_DI()      (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR, 12) = 0)
+
+#define STM32F4xx_DMA1_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR, 21) = 1)
+#define STM32F4xx_DMA1_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR, 21) = 0)
+#define STM32F4xx_DMA2_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR, 22) = 1)
+#define STM32F4xx_DMA2_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB1ENR, 22) = 0)
+
+#define STM32F4xx_USB_FS_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB2ENR,  7) = 1)
+#define STM32F4xx_USB_FS_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_AHB2ENR,  7) = 0)
+
+#define STM32F4xx_TIM1_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  0) = 1)
+#define STM32F4xx_TIM1_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  0) = 0)
+#define STM32F4xx_TIM2_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  0) = 1)
+#define STM32F4xx_TIM2_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  0) = 0)
+#define STM32F4xx_TIM3_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  1) = 1)
+#define STM32F4xx_TIM3_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  1) = 0)
+#define STM32F4xx_TIM4_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  2) = 1)
+#define STM32F4xx_TIM4_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  2) = 0)
+#define STM32F4xx_TIM5_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  3) = 1)
+#define STM32F4xx_TIM5_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  3) = 0)
+#define STM32F4xx_TIM6_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  4) = 1)
+#define STM32F4xx_TIM6_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  4) = 0)
+#define STM32F4xx_TIM7_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  5) = 1)
+#define STM32F4xx_TIM7_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  5) = 0)
+#define STM32F4xx_TIM8_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  1) = 1)
+#define STM32F4xx_TIM8_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  1) = 0)
+#define STM32F4xx_TIM9_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 16) = 1)
+#define STM32F4xx_TIM9_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 16) = 0)
+#define STM32F4xx_TIM10_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 17) = 1)
+#define STM32F4xx_TIM10_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 17) = 0)
+#define STM32F4xx_TIM11_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 18) = 1)
+#define STM32F4xx_TIM11_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 18) = 0)
+#define STM32F4xx_TIM12_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  6) = 1)
+#define STM32F4xx_TIM12_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  6) = 0)
+#define STM32F4xx_TIM13_PCLK_EN()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  7) = 1)
+#define STM32F4xx_TIM13_PCLK_DI()    (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR,  7) = 0)
+
+#define STM32F4xx_WWDG_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 11) = 1)
+#define STM32F4xx_WWDG_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 11) = 0)
+
+#define STM32F4xx_PWR_PCLK_EN()      (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 28) = 1)
+#define STM32F4xx_PWR_PCLK_DI()      (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 28) = 0)
+
+#define STM32F4xx_I2C1_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 21) = 1)
+#define STM32F4xx_I2C1_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 21) = 0)
+#define STM32F4xx_I2C2_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 22) = 1)
+#define STM32F4xx_I2C2_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 22) = 0)
+#define STM32F4xx_I2C3_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 23) = 1)
+#define STM32F4xx_I2C3_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 23) = 0)
+
+#define STM32F4xx_SPI1_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 12) = 1)
+#define STM32F4xx_SPI1_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 12) = 0)
+#define STM32F4xx_SPI2_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 14) = 1)
+#define STM32F4xx_SPI2_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 14) = 0)
+#define STM32F4xx_SPI3_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 15) = 1)
+#define STM32F4xx_SPI3_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 15) = 0)
+#define STM32F4xx_SPI4_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 13) = 1)
+#define STM32F4xx_SPI4_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 13) = 0)
+#define STM32F4xx_SPI5_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 20) = 1)
+#define STM32F4xx_SPI5_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 20) = 0)
+
+#define STM32F4xx_USART1_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  4) = 1)
+#define STM32F4xx_USART1_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  4) = 0)
+#define STM32F4xx_USART2_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 17) = 1)
+#define STM32F4xx_USART2_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 17) = 0)
+#define STM32F4xx_USART3_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 18) = 1)
+#define STM32F4xx_USART3_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 18) = 0)
+#define STM32F4xx_USART4_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 19) = 1)
+#define STM32F4xx_USART4_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 19) = 0)
+#define STM32F4xx_USART5_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 20) = 1)
+#define STM32F4xx_USART5_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB1ENR, 20) = 0)
+#define STM32F4xx_USART6_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  5) = 1)
+#define STM32F4xx_USART6_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  5) = 0)
+
+#define STM32F4xx_ADC1_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  8) = 1)
+#define STM32F4xx_ADC1_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR,  8) = 0)
+
+#define STM32F4xx_SDIO_PCLK_EN()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 11) = 1)
+#define STM32F4xx_SDIO_PCLK_DI()     (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 11) = 0)
+
+#define STM32F4xx_SYSCFG_PCLK_EN()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 14) = 1)
+#define STM32F4xx_SYSCFG_PCLK_DI()   (STM32F4xx_BITBAND(STM32F4xx_RCC->RCC_APB2ENR, 14) = 0)
 
 typedef struct
 {
@@ -819,6 +916,62 @@ typedef struct
 #define _MMIO_ADDR_DMA1     0x40026000UL
 #define _MMIO_ADDR_DMA2     0x40026400UL
 
+typedef struct
+{
+    volatile uint32_t CR;       // 0x00 Stream configuration register
+    volatile uint32_t NDTR;     // 0x04 Stream number of data register
+    volatile uint32_t PAR;      // 0x08 Stream peripheral address register
+    volatile uint32_t M0AR;     // 0x0C Stream memory 0 address register
+    volatile uint32_t M1AR;     // 0x10 Stream memory 1 address register
+    volatile uint32_t FCR;      // 0x14 Stream FIFO control register
+} STM32F4xx_DMA_Stream_RegDef_t;
+
+typedef struct
+{
+    volatile uint32_t LISR;     // 0x00 Low interrupt status register (streams 0-3)
+    volatile uint32_t HISR;     // 0x04 High interrupt status register (streams 4-7)
+    volatile uint32_t LIFCR;    // 0x08 Low interrupt flag clear register
+    volatile uint32_t HIFCR;    // 0x0C High interrupt flag clear register
+    STM32F4xx_DMA_Stream_RegDef_t STREAM[8];    // 0x10 + 0x18 * stream
+} STM32F4xx_DMA_RegDef_t;
+
+#define STM32F4xx_DMA1          ((STM32F4xx_DMA_RegDef_t* ) _MMIO_ADDR_DMA1)
+#define STM32F4xx_DMA2          ((STM32F4xx_DMA_RegDef_t* ) _MMIO_ADDR_DMA2)
+
+// DMA stream configuration register
+#define STM32F4xx_DMA_CR_EN             (0x1UL << 0)    // stream enable
+#define STM32F4xx_DMA_CR_DMEIE          (0x1UL << 1)    // direct mode error interrupt enable
+#define STM32F4xx_DMA_CR_TEIE           (0x1UL << 2)    // transfer error interrupt enable
+#define STM32F4xx_DMA_CR_HTIE           (0x1UL << 3)    // half transfer interrupt enable
+#define STM32F4xx_DMA_CR_TCIE           (0x1UL << 4)    // transfer complete interrupt enable
+#define STM32F4xx_DMA_CR_DIR_P2M        (0x0UL << 6)    // peripheral to memory
+#define STM32F4xx_DMA_CR_DIR_M2P        (0x1UL << 6)    // memory to peripheral
+#define STM32F4xx_DMA_CR_CIRC           (0x1UL << 8)    // circular mode
+#define STM32F4xx_DMA_CR_PINC           (0x1UL << 9)    // peripheral increment mode
+#define STM32F4xx_DMA_CR_MINC           (0x1UL << 10)   // memory increment mode
+#define STM32F4xx_DMA_CR_PSIZE_16       (0x1UL << 11)   // peripheral data size half word
+#define STM32F4xx_DMA_CR_PSIZE_32       (0x2UL << 11)   // peripheral data size word
+#define STM32F4xx_DMA_CR_MSIZE_16       (0x1UL << 13)   // memory data size half word
+#define STM32F4xx_DMA_CR_MSIZE_32       (0x2UL << 13)   // memory data size word
+#define STM32F4xx_DMA_CR_PL_VERY_HIGH   (0x3UL << 16)   // priority level very high
+#define STM32F4xx_DMA_CR_DBM            (0x1UL << 18)   // double buffer mode
+#define STM32F4xx_DMA_CR_CT             (0x1UL << 19)   // current target (0: M0AR, 1: M1AR)
+#define STM32F4xx_DMA_CR_CHSEL(channel) (((uint32_t)(channel) & 0x7) << 25)
+
+// DMA stream FIFO control register
+#define STM32F4xx_DMA_FCR_DMDIS         (0x1UL << 2)    // direct mode disable
+#define STM32F4xx_DMA_FCR_FTH_FULL      (0x3UL << 0)    // FIFO threshold full
+
+// DMA interrupt flags of a stream, shifted by STM32F4xx_DMA_FLAG_SHIFT(stream)
+// inside LISR/LIFCR (streams 0-3) or HISR/HIFCR (streams 4-7)
+#define STM32F4xx_DMA_FLAG_FE           (0x1UL << 0)    // FIFO error
+#define STM32F4xx_DMA_FLAG_DME          (0x1UL << 2)    // direct mode error
+#define STM32F4xx_DMA_FLAG_TE           (0x1UL << 3)    // transfer error
+#define STM32F4xx_DMA_FLAG_HT           (0x1UL << 4)    // half transfer
+#define STM32F4xx_DMA_FLAG_TC           (0x1UL << 5)    // transfer complete
+#define STM32F4xx_DMA_FLAG_ALL          (0x3DUL)
+#define STM32F4xx_DMA_FLAG_SHIFT(stream) ((((stream) & 0x2) << 3) + (((stream) & 0x1) * 6))
+
 #define _MMIO_ADDR_TIM1     0x40010000UL
 #define _MMIO_ADDR_TIM8     0x40013400UL
 
@@ -837,6 +990,52 @@ typedef struct
 #define _MMIO_ADDR_TIM13    0x40001C00UL
 #define _MMIO_ADDR_TIM14    0x40002000UL
 
+// register set of the advanced control timers, the general purpose timers
+// implement a subset of it
+typedef struct
+{
+    volatile uint32_t CR1;      // 0x00 Control register 1
+    volatile uint32_t CR2;      // 0x04 Control register 2
+    volatile uint32_t SMCR;     // 0x08 Slave mode control register
+    volatile uint32_t DIER;     // 0x0C DMA/interrupt enable register
+    volatile uint32_t SR;       // 0x10 Status register
+    volatile uint32_t EGR;      // 0x14 Event generation register
+    volatile uint32_t CCMR1;    // 0x18 Capture/compare mode register 1
+    volatile uint32_t CCMR2;    // 0x1C Capture/compare mode register 2
+    volatile uint32_t CCER;     // 0x20 Capture/compare enable register
+    volatile uint32_t CNT;      // 0x24 Counter
+    volatile uint32_t PSC;      // 0x28 Prescaler
+    volatile uint32_t ARR;      // 0x2C Auto-reload register
+    volatile uint32_t RCR;      // 0x30 Repetition counter register
+    volatile uint32_t CCR1;     // 0x34 Capture/compare register 1
+    volatile uint32_t CCR2;     // 0x38 Capture/compare register 2
+    volatile uint32_t CCR3;     // 0x3C Capture/compare register 3
+    volatile uint32_t CCR4;     // 0x40 Capture/compare register 4
+    volatile uint32_t BDTR;     // 0x44 Break and dead-time register
+    volatile uint32_t DCR;      // 0x48 DMA control register
+    volatile uint32_t DMAR;     // 0x4C DMA address for full transfer
+    volatile uint32_t OR;       // 0x50 Option register (TIM2, TIM5, TIM11)
+} STM32F4xx_TIM_RegDef_t;
+
+#define STM32F4xx_TIM1          ((STM32F4xx_TIM_RegDef_t* ) _MMIO_ADDR_TIM1)
+#define STM32F4xx_TIM2          ((STM32F4xx_TIM_RegDef_t* ) _MMIO_ADDR_TIM2)
+#define STM32F4xx_TIM3          ((STM32F4xx_TIM_RegDef_t* ) _MMIO_ADDR_TIM3)
+#define STM32F4xx_TIM4          ((STM32F4xx_TIM_RegDef_t* ) _MMIO_ADDR_TIM4)
+#define STM32F4xx_TIM5          ((STM32F4xx_TIM_RegDef_t* ) _MMIO_ADDR_TIM5)
+
+#define STM32F4xx_TIM_CR1_CEN           (0x1UL << 0)    // counter enable
+#define STM32F4xx_TIM_CR1_URS           (0x1UL << 2)    // update request source, only over/underflow
+#define STM32F4xx_TIM_CR1_OPM           (0x1UL << 3)    // one pulse mode
+#define STM32F4xx_TIM_CR1_ARPE          (0x1UL << 7)    // auto-reload preload enable
+#define STM32F4xx_TIM_DIER_UIE          (0x1UL << 0)    // update interrupt enable
+#define STM32F4xx_TIM_DIER_CCIE(ch)     (0x1UL << (ch)) // capture/compare 1-4 interrupt enable
+#define STM32F4xx_TIM_DIER_UDE          (0x1UL << 8)    // update DMA request enable
+#define STM32F4xx_TIM_DIER_CCDE(ch)     (0x1UL << ((ch) + 8))   // capture/compare 1-4 DMA request enable
+#define STM32F4xx_TIM_SR_UIF            (0x1UL << 0)    // update interrupt flag
+#define STM32F4xx_TIM_SR_CCIF(ch)       (0x1UL << (ch)) // capture/compare 1-4 interrupt flag
+#define STM32F4xx_TIM_EGR_UG            (0x1UL << 0)    // update generation
+#define STM32F4xx_TIM_EGR_CCG(ch)       (0x1UL << (ch)) // capture/compare 1-4 generation
+
 #define _MMIO_ADDR_RTC      0x40002800UL 
 
 typedef union __STM32F4xx_RTC_TR_Regdef
@@ -1266,6 +1465,9 @@ typedef union __STM32F4xx_I2C_SR1_Regdef
     uint16_t raw;
 } STM32F4xx_I2C_SR1_Regdef_t;
 
+// error flags of SR1, cleared by writing 0, writing 1 has no effect
+#define STM32F4xx_I2C_SR1_ERRORS    0xDF00
+
 typedef union __STM32F4xx_I2C_SR2_Regdef
 {
     struct
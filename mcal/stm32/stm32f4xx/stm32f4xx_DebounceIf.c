@@ -0,0 +1,121 @@
+/**
+ * @file stm32f4xx_DebounceIf.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx implementation of the debounce API
+ *
+ * This file implements the generic debounce API for the
+ * STM32F4xx series. Each port is sampled with a single IDR
+ * read and debounced with a 2 bit vertical counter, i.e. all
+ * 16 pins of a port are handled with a few bitwise operations.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "DebounceIf.h"
+#include "stm32f4xx.h"
+
+typedef struct _stm32f4xx_debounce_port
+{
+    DebounceIf_callback_t callback;
+    uint16_t mask;                                  // debounced pins
+    uint16_t state;                                 // debounced state of the port
+    uint16_t count_0;                               // bit 0 of the vertical counters
+    uint16_t count_1;                               // bit 1 of the vertical counters
+} stm32f4xx_debounce_port_t;
+
+static stm32f4xx_debounce_port_t debounce_ports[8] = {};
+static uint32_t debounce_active = 0;                // bitmap of debounced port numbers
+
+std_return_type_t DebounceIf_add_port(GPIOIf_pin_t port, uint16_t mask, DebounceIf_callback_t callback)
+{
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    uint8_t port_number = (uint8_t) GPIOIf_get_port_number(port);
+    stm32f4xx_debounce_port_t *debounce = &debounce_ports[port_number];
+
+    // the tick must not see a half written entry
+    STM32F4xx_SRAM_BITBAND(debounce_active, port_number) = 0;
+
+    debounce->callback = callback;
+    debounce->mask = mask;
+    debounce->state = (uint16_t) STM32F4xx_GPIO_PORT_REG(port)->IDR;
+    debounce->count_0 = 0;
+    debounce->count_1 = 0;
+
+    STM32F4xx_SRAM_BITBAND(debounce_active, port_number) = 1;
+
+    return E_OK;
+}
+
+std_return_type_t DebounceIf_remove_port(GPIOIf_pin_t port)
+{
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    STM32F4xx_SRAM_BITBAND(debounce_active, GPIOIf_get_port_number(port)) = 0;
+
+    return E_OK;
+}
+
+std_return_type_t DebounceIf_get_state(GPIOIf_pin_t port, uint16_t *state)
+{
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+    if(state == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+
+    uint8_t port_number = (uint8_t) GPIOIf_get_port_number(port);
+    if((debounce_active & (1UL << port_number)) == 0)
+    {
+        return E_STATE_NOINIT;
+    }
+
+    *state = debounce_ports[port_number].state;
+
+    return E_OK;
+}
+
+void DebounceIf_tick(void)
+{
+    uint32_t active = debounce_active;
+
+    while(active)
+    {
+        uint32_t port_number = __builtin_ctz(active);
+        active &= active - 1;   // clear lowest set bit
+
+        stm32f4xx_debounce_port_t *debounce = &debounce_ports[port_number];
+        uint16_t sample = (uint16_t) STM32F4xx_GPIO_PORT_REG(port_number << 8)->IDR;
+
+        // vertical counter: the counter of each pin which differs from
+        // the debounced state counts 0, 1, 2, 3 and wraps to 0 on the
+        // 4th sample, a pin which equals the state resets its counter
+        uint16_t delta = (sample ^ debounce->state) & debounce->mask;
+        debounce->count_1 = (debounce->count_1 ^ debounce->count_0) & delta;
+        debounce->count_0 = ~debounce->count_0 & delta;
+
+        uint16_t changed = delta & ~(debounce->count_0 | debounce->count_1);
+        if(changed == 0)
+        {
+            continue;
+        }
+
+        debounce->state ^= changed;
+        if(debounce->callback != NULL)
+        {
+            debounce->callback((GPIOIf_pin_t) ((port_number << 8) | 0xFF), changed, debounce->state);
+        }
+    }
+}
@@ -0,0 +1,212 @@
+/**
+ * @file stm32f4xx_EncoderIf.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx implementation of the quadrature encoder API
+ *
+ * This file implements the generic encoder API for the STM32F4xx
+ * series. Both phases are read with a single IDR access and the
+ * position is updated through a state transition table without
+ * branches.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "EncoderIf.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_interrupt.h"
+
+#define STM32F4xx_ENCODER_COUNT     4
+
+// transitions where both phases changed, i.e. an edge was lost
+#define STM32F4xx_ENCODER_INVALID_TRANSITIONS  ((1 << 0x3) | (1 << 0x6) | (1 << 0x9) | (1 << 0xC))
+
+typedef struct _stm32f4xx_encoder
+{
+    STM32F4xx_GPIO_RegDef_t *port;
+    uint8_t shift_a;                                // pin number of phase A
+    uint8_t shift_b;                                // pin number of phase B
+    uint8_t state;                                  // last state, bit 0 phase A, bit 1 phase B
+    boolean initialized;
+    volatile int32_t position;
+    volatile uint32_t errors;
+    GPIOIf_pin_t pin_a;
+    GPIOIf_pin_t pin_b;
+} stm32f4xx_encoder_t;
+
+// position change by index (last state << 2) | new state, the phases
+// follow the gray code 00 -> 01 -> 11 -> 10 in forward direction
+static const int8_t quadrature_table[16] =
+{
+     0,  1, -1,  0,
+    -1,  0,  0,  1,
+     1,  0,  0, -1,
+     0, -1,  1,  0,
+};
+
+static stm32f4xx_encoder_t encoders[STM32F4xx_ENCODER_COUNT] = {};
+
+static inline __attribute__((always_inline)) uint8_t read_state(const stm32f4xx_encoder_t *encoder)
+{
+    uint32_t idr = encoder->port->IDR;
+    return ((idr >> encoder->shift_a) & 0x01) | (((idr >> encoder->shift_b) & 0x01) << 1);
+}
+
+static inline __attribute__((always_inline)) void decode(stm32f4xx_encoder_t *encoder)
+{
+    uint8_t state = read_state(encoder);
+    uint8_t index = (encoder->state << 2) | state;
+
+    encoder->state = state;
+    encoder->position += quadrature_table[index];
+    encoder->errors += (STM32F4xx_ENCODER_INVALID_TRANSITIONS >> index) & 0x01;
+}
+
+// EXTI callbacks have no argument, one entry per encoder
+static void encoder_0_edge(void) { decode(&encoders[0]); }
+static void encoder_1_edge(void) { decode(&encoders[1]); }
+static void encoder_2_edge(void) { decode(&encoders[2]); }
+static void encoder_3_edge(void) { decode(&encoders[3]); }
+
+static void (* const encoder_edges[STM32F4xx_ENCODER_COUNT])(void) =
+{
+    encoder_0_edge, encoder_1_edge, encoder_2_edge, encoder_3_edge,
+};
+
+static boolean encoder_exists(identifier_t encoder_id)
+{
+    return (encoder_id >= 0 && encoder_id < STM32F4xx_ENCODER_COUNT) ? TRUE : FALSE;
+}
+
+std_return_type_t EncoderIf_init(identifier_t encoder_id, const EncoderIf_config_t *cfg)
+{
+    if(FALSE == encoder_exists(encoder_id))
+    {
+        return E_NOT_EXISTING;
+    }
+    if(cfg == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+    if(GPIOIf_get_port(cfg->pin_a) != GPIOIf_get_port(cfg->pin_b) ||
+       GPIOIf_get_pin_number(cfg->pin_a) == GPIOIf_get_pin_number(cfg->pin_b))
+    {
+        return E_CFG_ERR;
+    }
+
+    stm32f4xx_encoder_t *encoder = &encoders[encoder_id];
+    GPIOIf_pin_config_t pin_cfgs[2] = {};
+
+    pin_cfgs[0].pin = cfg->pin_a;
+    pin_cfgs[1].pin = cfg->pin_b;
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        pin_cfgs[i].callback = encoder_edges[encoder_id];
+        pin_cfgs[i].pin_mode = GPIOIf_INPUT;
+        pin_cfgs[i].pullup_mode = cfg->pullup_mode;
+        pin_cfgs[i].output_mode = GPIOIF_OUTPUT_PUSH_PULL;
+        pin_cfgs[i].trigger = GPIOIf_NO_TRIGGER;
+    }
+
+    // the interrupts of a previous configuration must not see a
+    // partially updated encoder
+    if(encoder->initialized == TRUE)
+    {
+        (void) EncoderIf_deinit(encoder_id);
+    }
+
+    encoder->port = STM32F4xx_GPIO_PORT_REG(cfg->pin_a);
+    encoder->shift_a = (uint8_t) GPIOIf_get_pin_number(cfg->pin_a);
+    encoder->shift_b = (uint8_t) GPIOIf_get_pin_number(cfg->pin_b);
+    encoder->pin_a = cfg->pin_a;
+    encoder->pin_b = cfg->pin_b;
+    encoder->position = 0;
+    encoder->errors = 0;
+
+    // the pins become inputs first, so the state can be read before an
+    // edge interrupt decodes against it
+    std_return_type_t status = GPIOIf_config_pins(pin_cfgs, 2);
+    if(status != E_OK)
+    {
+        return status;
+    }
+    encoder->state = read_state(encoder);
+
+    // edges before the state is read again are part of the state, later
+    // ones stay pending until the critical section ends
+    pin_cfgs[0].trigger = GPIOIf_BOTH_EDGES;
+    pin_cfgs[1].trigger = GPIOIf_BOTH_EDGES;
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    status = GPIOIf_config_pins(pin_cfgs, 2);
+    encoder->state = read_state(encoder);
+    stm32f4xx_critical_exit(critical);
+    if(status != E_OK)
+    {
+        return status;
+    }
+    encoder->initialized = TRUE;
+
+    return E_OK;
+}
+
+std_return_type_t EncoderIf_deinit(identifier_t encoder_id)
+{
+    if(FALSE == encoder_exists(encoder_id))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    stm32f4xx_encoder_t *encoder = &encoders[encoder_id];
+    if(encoder->initialized == FALSE)
+    {
+        return E_STATE_NOINIT;
+    }
+
+    GPIOIf_pin_config_t pin_cfgs[2] = {};
+    pin_cfgs[0].pin = encoder->pin_a;
+    pin_cfgs[1].pin = encoder->pin_b;
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        pin_cfgs[i].pin_mode = GPIOIf_INPUT;
+        pin_cfgs[i].output_mode = GPIOIF_OUTPUT_PUSH_PULL;
+        pin_cfgs[i].trigger = GPIOIf_NO_TRIGGER;
+    }
+
+    encoder->initialized = FALSE;
+
+    return GPIOIf_config_pins(pin_cfgs, 2);
+}
+
+int32_t EncoderIf_get_position(identifier_t encoder_id)
+{
+    if(FALSE == encoder_exists(encoder_id))
+    {
+        return 0;
+    }
+
+    return encoders[encoder_id].position;
+}
+
+std_return_type_t EncoderIf_set_position(identifier_t encoder_id, int32_t position)
+{
+    if(FALSE == encoder_exists(encoder_id))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    encoders[encoder_id].position = position;
+
+    return E_OK;
+}
+
+uint32_t EncoderIf_get_errors(identifier_t encoder_id)
+{
+    if(FALSE == encoder_exists(encoder_id))
+    {
+        return 0;
+    }
+
+    return encoders[encoder_id].errors;
+}
@@ -16,22 +16,169 @@
 #include "stm32f4xx.h"
 #include "stm32f4xx_interrupt.h"
 
+// external interrupt lines 0-22, lines 19 and 20 are not available
+#define STM32F4xx_EXTI_LINES            23
 
+// number of edge events buffered per timestamped line, power of two
+#ifndef STM32F4xx_GPIO_EDGE_BUFFER_SIZE
+#define STM32F4xx_GPIO_EDGE_BUFFER_SIZE 8
+#endif
 
-static void (*EXTI_cbs[16]) (void) = {};
-static uint16_t EXTI_mask = 0; 
+#if (STM32F4xx_GPIO_EDGE_BUFFER_SIZE & (STM32F4xx_GPIO_EDGE_BUFFER_SIZE - 1)) != 0
+#error "STM32F4xx_GPIO_EDGE_BUFFER_SIZE has to be a power of two"
+#endif
+
+// single producer (EXTI interrupt) single consumer ring buffer, head and 
+// tail are free running and only written by the producer/consumer
+typedef struct _stm32f4xx_edge_buffer
+{
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    GPIOIf_edge_event_t events[STM32F4xx_GPIO_EDGE_BUFFER_SIZE];
+} stm32f4xx_edge_buffer_t;
+
+// number of deferred edges which can be queued, power of two
+#ifndef STM32F4xx_GPIO_EVENT_QUEUE_SIZE
+#define STM32F4xx_GPIO_EVENT_QUEUE_SIZE 32
+#endif
+
+#if (STM32F4xx_GPIO_EVENT_QUEUE_SIZE & (STM32F4xx_GPIO_EVENT_QUEUE_SIZE - 1)) != 0
+#error "STM32F4xx_GPIO_EVENT_QUEUE_SIZE has to be a power of two"
+#endif
+
+// event word of a queued edge, 0 marks a free or not yet written slot
+#define STM32F4xx_GPIO_EVENT_VALID          (0x1UL << 31)
+#define STM32F4xx_GPIO_EVENT_LINE_MASK      (0xFFUL)
+
+// the callback is taken when the edge is queued, so an edge queued before
+// its line is reconfigured calls the callback it was configured with.
+// Timestamps are recorded by GPIOIF_EXTI_TIMESTAMP, which can be combined
+// with GPIOIF_EXTI_DEFERRED.
+typedef struct _stm32f4xx_event_slot
+{
+    void (*callback) (void);
+    volatile uint32_t info;                         // line and valid flag
+} stm32f4xx_event_slot_t;
+
+// multiple producer (nested EXTI interrupts) single consumer queue, 
+// producers reserve a slot by an atomic increment of head and publish 
+// it by writing the info word. The consumer stops at the first slot which
+// is reserved but not yet written.
+typedef struct _stm32f4xx_event_queue
+{
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    stm32f4xx_event_slot_t slots[STM32F4xx_GPIO_EVENT_QUEUE_SIZE];
+} stm32f4xx_event_queue_t;
+
+static void (*EXTI_cbs[STM32F4xx_EXTI_LINES]) (void) = {};
+static uint32_t EXTI_mask = 0; 
+static uint32_t EXTI_signal_mask = 0;                   // lines used as software signal
+static uint32_t EXTI_event_mask = 0;                    // lines which only generate wakeup events
+static uint32_t EXTI_timestamp_mask = 0;
+static uint32_t EXTI_deferred_mask = 0;
+static stm32f4xx_event_queue_t EXTI_events = {};
+static uint32_t EXTI_events_posted = FALSE;             // the queue is drained by a deferred work item
+static GPIOIf_pin_t EXTI_pins[16] = {};
+static uint8_t EXTI_triggers[16] = {};                  // GPIOIf_trigger_t of each line
+static stm32f4xx_edge_buffer_t EXTI_edges[16] = {};
 
-static boolean pin_exists(GPIOIf_pin_t pin);
 static STM32F4xx_GPIO_RegDef_t *get_port_register (GPIOIf_pin_t pin);
 
-static void set_interrupt_register(GPIOIf_pin_t pin);
-static void clear_interrupt_register(GPIOIf_pin_t pin);
+typedef struct _stm32f4xx_GPIO_port_image
+{
+    uint32_t MODER;
+    uint32_t OTYPER;
+    uint32_t OSPEEDR;
+    uint32_t PUPDR;
+    uint32_t AFRL;
+    uint32_t AFRH;
+} stm32f4xx_GPIO_port_image_t;
+
+// RAM copy of the configuration registers of each port, the registers are
+// only written and never read back. Ports start with their reset values
+// and are synchronised with the hardware by GPIOIf_init().
+static stm32f4xx_GPIO_port_image_t GPIO_shadows[8] = 
+{
+    [0] = { .MODER = 0xA8000000, .OSPEEDR = 0x0C000000, .PUPDR = 0x64000000 },  // debug port pins
+    [1] = { .MODER = 0x00000280, .OSPEEDR = 0x000000C0, .PUPDR = 0x00000100 },
+};
 
-static std_return_type_t set_pin_mode(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port );
-static std_return_type_t set_output_mode(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port );
-static std_return_type_t set_pullup_cfg(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port );
-static std_return_type_t set_alternate_function(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port );
-static std_return_type_t set_input_trigger(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port );
+// RAM copy of the EXTI port selection registers SYSCFG_EXTICR1..4, they 
+// are only written through commit_register() and start with their reset 
+// values
+static uint32_t EXTICR_shadows[4];
+
+typedef struct _stm32f4xx_EXTI_image
+{
+    uint32_t IMR;
+    uint32_t EMR;
+    uint32_t RTSR;
+    uint32_t FTSR;
+    uint32_t EXTICR[4];
+    uint32_t EXTICR_bases[4];                       // shadow values EXTICR was calculated from
+    void (*callbacks[16]) (void);
+    uint16_t lines_enabled;                         // lines which shall trigger an interrupt
+    uint16_t lines_disabled;                        // lines which shall no longer trigger an interrupt
+    uint16_t lines_timestamped;                     // enabled lines which shall record edge events
+    uint16_t lines_deferred;                        // enabled lines of which the callback is deferred
+    uint16_t lines_event;                           // enabled lines which generate events instead of interrupts
+    uint16_t lines_prioritized;                     // enabled lines of which the IRQ priority is set
+    uint8_t priorities[16];                         // IRQ priority of the prioritized lines
+} stm32f4xx_EXTI_image_t;
+
+// IRQ of each EXTI line, lines 5-9 and 10-15 share one IRQ
+static const STM32F4xx_IRQ_t EXTI_irqs[STM32F4xx_EXTI_LINES] = 
+{
+    STM32F4xx_EXTI0_IRQ,        STM32F4xx_EXTI1_IRQ,        STM32F4xx_EXTI2_IRQ,        STM32F4xx_EXTI3_IRQ,
+    STM32F4xx_EXTI4_IRQ,        STM32F4xx_EXTI9_5_IRQ,      STM32F4xx_EXTI9_5_IRQ,      STM32F4xx_EXTI9_5_IRQ,
+    STM32F4xx_EXTI9_5_IRQ,      STM32F4xx_EXTI9_5_IRQ,      STM32F4xx_EXTI15_10_IRQ,    STM32F4xx_EXTI15_10_IRQ,
+    STM32F4xx_EXTI15_10_IRQ,    STM32F4xx_EXTI15_10_IRQ,    STM32F4xx_EXTI15_10_IRQ,    STM32F4xx_EXTI15_10_IRQ,
+    STM32F4xx_EXTI16_PVD_IRQ,   STM32F4xx_EXTI17_RTC_ALARM_IRQ,                         STM32F4xx_EXTI18_OTG_FS_WKUP_IRQ,
+    [21] = STM32F4xx_EXTI21_TAMP_STAMP_IRQ,                 STM32F4xx_EXTI22_RTC_WKUP_IRQ,
+};
+
+// lines served by the IRQ of each EXTI line
+static const uint32_t EXTI_irq_lines[STM32F4xx_EXTI_LINES] = 
+{
+    0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x03E0, 0x03E0, 0x03E0, 
+    0x03E0, 0x03E0, 0xFC00, 0xFC00, 0xFC00, 0xFC00, 0xFC00, 0xFC00,
+    0x10000, 0x20000, 0x40000, 0x00000, 0x00000, 0x200000, 0x400000,
+};
+
+static void EXTI16_signal_handler(void);
+static void EXTI18_signal_handler(void);
+static void EXTI21_signal_handler(void);
+static void EXTI22_signal_handler(void);
+
+// handler of each signal line which does not share its IRQ with a pin, 
+// the IRQs of lines 0-15 are always served by this driver
+static void (* const EXTI_signal_handlers[STM32F4xx_EXTI_LINES]) (void) = 
+{
+    [16] = EXTI16_signal_handler,
+    [18] = EXTI18_signal_handler,
+    [21] = EXTI21_signal_handler,
+    [22] = EXTI22_signal_handler,
+};
+
+// pin mode of each MODER value: 00 input, 01 output, 10 alternate function, 11 analog
+static const GPIOIf_pin_mode_t GPIO_modes[4] = 
+{
+    GPIOIf_INPUT,               GPIOIf_OUTPUT,              GPIOIf_ALTERNAT_FN,         GPIOIf_INPUT_ANALOG,
+};
+
+static void read_port_image(STM32F4xx_GPIO_RegDef_t *port, stm32f4xx_GPIO_port_image_t *image);
+static void commit_port_image(uint8_t port_number, const stm32f4xx_GPIO_port_image_t *base, 
+                              const stm32f4xx_GPIO_port_image_t *image);
+static void commit_register(uint32_t *shadow, volatile uint32_t *reg, uint32_t base, uint32_t value);
+static void write_EXTI_image(stm32f4xx_EXTI_image_t *image);
+
+static std_return_type_t set_pin_mode(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port );
+static std_return_type_t set_output_mode(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port );
+static std_return_type_t set_output_speed(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port );
+static std_return_type_t set_pullup_cfg(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port );
+static std_return_type_t set_alternate_function(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port );
+static std_return_type_t set_input_trigger(const GPIOIf_pin_config_t *cfg, stm32f4xx_EXTI_image_t *exti );
 
 std_return_type_t GPIOIf_init(GPIOIf_pin_t port)
 {
@@ -59,6 +206,15 @@ std_return_type_t GPIOIf_init(GPIOIf_pin_t port)
         return E_NOT_EXISTING;
         break;
     }
+
+    // the port can be accessed two cycles after its clock is enabled
+    (void) STM32F4xx_RCC->RCC_AHB1ENR.raw;
+    // take over the configuration of a bootloader or previous user
+    read_port_image(get_port_register(port), &GPIO_shadows[GPIOIf_get_port_number(port)]);
+
+    // time base of edge timestamps and snapshots
+    STM32F4xx_CYCCNT_ENABLE();
+
     return E_OK;
     
 }
@@ -94,42 +250,156 @@ std_return_type_t GPIOIf_deinit(GPIOIf_pin_t port)
 
 std_return_type_t GPIOIf_config_pin(GPIOIf_pin_config_t *cfg)
 {
-    if(FALSE == pin_exists( cfg->pin))
+    return GPIOIf_config_pins(cfg, 1);
+}
+
+std_return_type_t GPIOIf_config_pins(const GPIOIf_pin_config_t *cfgs, size_t n)
+{
+    stm32f4xx_GPIO_port_image_t ports[8];
+    stm32f4xx_GPIO_port_image_t bases[8];
+    stm32f4xx_EXTI_image_t exti;
+    uint8_t ports_touched = 0;
+    std_return_type_t status = E_OK;
+
+    if(cfgs == NULL)
     {
-        return E_NOT_EXISTING;
+        return E_VALUE_NULL;
     }
 
-    STM32F4xx_GPIO_RegDef_t *port = get_port_register(cfg->pin);
-
-    std_return_type_t status = set_pin_mode(cfg, port);
-    if(status != E_OK)
+    // read EXTI configuration once, lines are configured in RAM
+    exti.IMR  = STM32F4xx_EXTI->EXTI_IMR;
+    exti.EMR  = STM32F4xx_EXTI->EXTI_EMR;
+    exti.RTSR = STM32F4xx_EXTI->EXTI_RTSR;
+    exti.FTSR = STM32F4xx_EXTI->EXTI_FTSR;
+    for(uint8_t i = 0; i < 4; i++)
     {
-        return status;
+        exti.EXTICR_bases[i] = __atomic_load_n(&EXTICR_shadows[i], __ATOMIC_ACQUIRE);
+        exti.EXTICR[i] = exti.EXTICR_bases[i];
+    }
+    exti.lines_enabled = 0;
+    exti.lines_disabled = 0;
+    exti.lines_timestamped = 0;
+    exti.lines_deferred = 0;
+    exti.lines_event = 0;
+    exti.lines_prioritized = 0;
+    for(uint8_t line = 0; line < 16; line++)
+    {
+        exti.priorities[line] = 0;
     }
 
-    status = set_output_mode(cfg, port);
-    if(status != E_OK)
+    // calculate final register values of all ports, nothing is written
+    // to the peripherals if one of the configurations is invalid
+    for(size_t i = 0; i < n; i++)
     {
-        return status;
+        const GPIOIf_pin_config_t *cfg = &cfgs[i];
+
+        if(FALSE == stm32f4xx_GPIO_pin_exists(cfg->pin))
+        {
+            return E_NOT_EXISTING;
+        }
+
+        uint8_t port_number = (uint8_t) GPIOIf_get_port_number(cfg->pin);
+        stm32f4xx_GPIO_port_image_t *port = &ports[port_number];
+
+        // copy each port from its shadow on first use
+        if((ports_touched & (1 << port_number)) == 0)
+        {
+            bases[port_number] = GPIO_shadows[port_number];
+            *port = bases[port_number];
+            ports_touched |= (1 << port_number);
+        }
+
+        status = set_pin_mode(cfg, port);
+        if(status != E_OK)
+        {
+            return status;
+        }
+
+        status = set_output_mode(cfg, port);
+        if(status != E_OK)
+        {
+            return status;
+        }
+
+        status = set_output_speed(cfg, port);
+        if(status != E_OK)
+        {
+            return status;
+        }
+
+        status = set_pullup_cfg(cfg, port);
+        if(status != E_OK)
+        {
+            return status;
+        }
+
+        status = set_input_trigger(cfg, &exti);
+        if(status != E_OK)
+        {
+            return status;
+        }
     }
 
-    status = set_pullup_cfg(cfg, port);
-    if(status != E_OK)
+    // write each changed register of a port once
+    for(uint8_t port_number = 0; port_number < 8; port_number++)
     {
-        return status;
+        if(ports_touched & (1 << port_number))
+        {
+            commit_port_image(port_number, &bases[port_number], &ports[port_number]);
+        }
     }
 
-    status = set_input_trigger(cfg, port);
-    if(status != E_OK)
+    write_EXTI_image(&exti);
+
+    return E_OK;
+}
+
+std_return_type_t GPIOIf_get_pin_config(GPIOIf_pin_t pin, GPIOIf_pin_config_t *cfg)
+{
+    if(cfg == NULL)
     {
-        return status;
+        return E_VALUE_NULL;
+    }
+    if(FALSE == stm32f4xx_GPIO_pin_exists(pin))
+    {
+        return E_NOT_EXISTING;
     }
 
+    const stm32f4xx_GPIO_port_image_t *shadow = &GPIO_shadows[GPIOIf_get_port_number(pin)];
+    uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(pin);
+    uint8_t shift = pin_number << 1;
+    uint32_t afr = (pin_number < 8) ? shadow->AFRL : shadow->AFRH;
+    uint32_t line = 1UL << pin_number;
+
+    cfg->pin = pin;
+    cfg->pin_mode = GPIO_modes[(shadow->MODER >> shift) & 0x3];
+    cfg->alternate_function = (afr >> ((pin_number & 0x7) << 2)) & 0xF;
+    cfg->pullup_mode = (GPIOIf_pullup_mode_t) ((shadow->PUPDR >> shift) & 0x3);
+    cfg->output_mode = ((shadow->OTYPER >> pin_number) & 0x1) ? GPIOIF_OUTPUT_OPEN_DRAIN : GPIOIF_OUTPUT_PUSH_PULL;
+    cfg->output_speed = (GPIOIf_output_speed_t) (((shadow->OSPEEDR >> shift) & 0x3) + GPIOIF_SPEED_LOW);
+    cfg->callback = NULL;
+    cfg->trigger = GPIOIf_NO_TRIGGER;
+    cfg->exti_flags = GPIOIF_EXTI_CALLBACK;
+    cfg->priority = 0;
+    cfg->set_priority = FALSE;
+
+    if(EXTI_pins[pin_number] == pin && (((EXTI_mask & ~EXTI_signal_mask) | EXTI_event_mask) & line))
+    {
+        cfg->callback = EXTI_cbs[pin_number];
+        cfg->trigger = (GPIOIf_trigger_t) EXTI_triggers[pin_number];
+        cfg->exti_flags = ((EXTI_timestamp_mask & line) ? GPIOIF_EXTI_TIMESTAMP : 0) |
+                          ((EXTI_deferred_mask & line) ? GPIOIF_EXTI_DEFERRED : 0) |
+                          ((EXTI_event_mask & line) ? GPIOIF_EXTI_EVENT : 0);
+        if((EXTI_event_mask & line) == 0)
+        {
+            cfg->set_priority = (stm32f4xx_get_interrupt_priority(EXTI_irqs[pin_number], &cfg->priority) == E_OK);
+        }
+    }
 
     return E_OK;
 }
 
-static std_return_type_t set_pin_mode(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port )
+static std_return_type_t set_pin_mode(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port )
 {
     uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(cfg->pin);
     std_return_type_t status = E_OK;
@@ -164,7 +434,7 @@ static std_return_type_t set_pin_mode(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_R
     return status;
 }
 
-static std_return_type_t set_output_mode(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port )
+static std_return_type_t set_output_mode(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port )
 {
 
     uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(cfg->pin);
@@ -188,7 +458,41 @@ static std_return_type_t set_output_mode(GPIOIf_pin_config_t *cfg, STM32F4xx_GPI
 
 }
 
-static std_return_type_t set_pullup_cfg(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port )
+static std_return_type_t set_output_speed(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port )
+{
+    uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(cfg->pin);
+    GPIOIf_output_speed_t speed = cfg->output_speed;
+
+    if(speed == GPIOIF_SPEED_DEFAULT)
+    {
+        // default speed depends on the signal class
+        switch (cfg->pin_mode)
+        {
+        case GPIOIf_OUTPUT:
+            speed = GPIOIF_SPEED_LOW_EMI;
+            break;
+        case GPIOIf_ALTERNAT_FN:
+            speed = GPIOIF_SPEED_PERIPHERAL;
+            break;
+        default:
+            // speed has no effect on inputs, keep current setting
+            return E_OK;
+            break;
+        }
+    }
+    else if(speed > GPIOIF_SPEED_VERY_HIGH)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    // OSPEEDR: 00 low, 01 medium, 10 fast, 11 high speed
+    port->OSPEEDR &= ~(0x3 << (pin_number <<1));
+    port->OSPEEDR |=  ((speed - GPIOIF_SPEED_LOW) << (pin_number <<1));
+
+    return E_OK;
+}
+
+static std_return_type_t set_pullup_cfg(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port )
 {
     uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(cfg->pin);
     switch (cfg->pullup_mode)
@@ -215,7 +519,7 @@ static std_return_type_t set_pullup_cfg(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO
     return E_OK;
 }
 
-static std_return_type_t set_alternate_function(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port )
+static std_return_type_t set_alternate_function(const GPIOIf_pin_config_t *cfg, stm32f4xx_GPIO_port_image_t *port )
 {
 
     if(cfg->alternate_function > 15)
@@ -241,38 +545,69 @@ static std_return_type_t set_alternate_function(GPIOIf_pin_config_t *cfg, STM32F
     return E_OK;
 }
 
-static std_return_type_t set_input_trigger(GPIOIf_pin_config_t *cfg, STM32F4xx_GPIO_RegDef_t *port )
+static std_return_type_t set_input_trigger(const GPIOIf_pin_config_t *cfg, stm32f4xx_EXTI_image_t *exti )
 {
     uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(cfg->pin);
+    uint8_t port_number = (uint8_t) GPIOIf_get_port_number(cfg->pin);
+    uint32_t *exticr = &exti->EXTICR[pin_number >> 2];
+    uint8_t shift = (pin_number & 0x3) << 2;
+    uint16_t line = (1 << pin_number);
+
+    if(cfg->exti_flags & ~(GPIOIF_EXTI_TIMESTAMP | GPIOIF_EXTI_DEFERRED | GPIOIF_EXTI_EVENT))
+    {
+        return E_NOT_SUPPORTED;
+    }
+    // the EXTI handlers share the line state with the critical sections
+    if(cfg->set_priority == TRUE && !STM32F4xx_DRIVER_PRIORITY_VALID(cfg->priority))
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+    // events do not enter an interrupt which could timestamp or queue them
+    if((cfg->exti_flags & GPIOIF_EXTI_EVENT) && cfg->exti_flags != GPIOIF_EXTI_EVENT)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    // lines used as software signal are not connected to any port
+    if(EXTI_signal_mask & line)
+    {
+        return (cfg->trigger == GPIOIf_NO_TRIGGER) ? E_OK : E_STATE_ERR;
+    }
 
     switch (cfg->trigger)
     {
         case GPIOIf_NO_TRIGGER:
+            // the line is shared by all ports, only release it if it is
+            // connected to the port of this pin
+            if(((*exticr >> shift) & 0xF) != port_number)
+            {
+                return E_OK;
+            }
             // clear rising trigger flag
-            STM32F4xx_EXTI->EXTI_RTSR    &= ~(0x1 << pin_number);
+            exti->RTSR    &= ~line;
             // clear falling trigger flag
-            STM32F4xx_EXTI->EXTI_FTSR    &= ~(0x1 << pin_number);
+            exti->FTSR    &= ~line;
 
             break;
         case GPIOIf_BOTH_EDGES :
             // set rising trigger flag
-            STM32F4xx_EXTI->EXTI_RTSR    |= (0x1 << pin_number);
+            exti->RTSR    |= line;
             // set falling trigger flag
-            STM32F4xx_EXTI->EXTI_FTSR    |= (0x1 << pin_number);
+            exti->FTSR    |= line;
             
             break;
         case GPIOIf_RISING_EDGE :
             // set rising trigger flag
-            STM32F4xx_EXTI->EXTI_RTSR    |= (0x1 << pin_number);
+            exti->RTSR    |= line;
             // clear falling trigger flag
-            STM32F4xx_EXTI->EXTI_FTSR    &= ~(0x1 << pin_number);
+            exti->FTSR    &= ~line;
 
             break;
         case GPIOIf_FALLING_EDGE :
             // clear rising trigger flag
-            STM32F4xx_EXTI->EXTI_RTSR    &= ~(0x1 << pin_number);
+            exti->RTSR    &= ~line;
             // set falling trigger flag
-            STM32F4xx_EXTI->EXTI_FTSR    |= (0x1 << pin_number);
+            exti->FTSR    |= line;
 
             break;
         default:
@@ -282,15 +617,67 @@ static std_return_type_t set_input_trigger(GPIOIf_pin_config_t *cfg, STM32F4xx_G
 
     if(cfg->trigger == GPIOIf_NO_TRIGGER)
     {
-        EXTI_mask &= ~(1 << pin_number);
-        EXTI_cbs[pin_number] = 0UL;
-        clear_interrupt_register(cfg->pin);
+        exti->IMR &= ~line;
+        exti->EMR &= ~line;
+        exti->callbacks[pin_number] = 0UL;
+        exti->lines_enabled &= ~line;
+        exti->lines_disabled |= line;
+        exti->lines_timestamped &= ~line;
+        exti->lines_deferred &= ~line;
+        exti->lines_event &= ~line;
+    }
+    else if(cfg->exti_flags & GPIOIF_EXTI_EVENT)
+    {
+        // connect line to the port of the pin
+        *exticr &= ~(0xF << shift);
+        *exticr |= (port_number << shift);
+
+        exti->IMR &= ~line;
+        exti->EMR |= line;
+        exti->callbacks[pin_number] = 0UL;
+        exti->lines_enabled |= line;
+        exti->lines_disabled &= ~line;
+        exti->lines_timestamped &= ~line;
+        exti->lines_deferred &= ~line;
+        exti->lines_event |= line;
     }
     else
     {
-        EXTI_cbs[pin_number] = cfg->callback;
-        EXTI_mask |= (1 << pin_number);
-        set_interrupt_register(cfg->pin);
+        // connect line to the port of the pin
+        *exticr &= ~(0xF << shift);
+        *exticr |= (port_number << shift);
+
+        exti->IMR |= line;
+        exti->EMR &= ~line;
+        exti->callbacks[pin_number] = cfg->callback;
+        exti->priorities[pin_number] = cfg->priority;
+        if(cfg->set_priority == TRUE)
+        {
+            exti->lines_prioritized |= line;
+        }
+        else
+        {
+            exti->lines_prioritized &= ~line;
+        }
+        exti->lines_enabled |= line;
+        exti->lines_disabled &= ~line;
+        exti->lines_event &= ~line;
+        if(cfg->exti_flags & GPIOIF_EXTI_TIMESTAMP)
+        {
+            exti->lines_timestamped |= line;
+        }
+        else
+        {
+            exti->lines_timestamped &= ~line;
+        }
+        if(cfg->exti_flags & GPIOIF_EXTI_DEFERRED)
+        {
+            exti->lines_deferred |= line;
+        }
+        else
+        {
+            exti->lines_deferred &= ~line;
+        }
     }
 
     return E_OK;
@@ -299,46 +686,113 @@ static std_return_type_t set_input_trigger(GPIOIf_pin_config_t *cfg, STM32F4xx_G
 
 std_return_type_t GPIOIf_pin_set(GPIOIf_pin_t pin)
 {
-    if(FALSE == pin_exists( pin))
+    if(FALSE == stm32f4xx_GPIO_pin_exists(pin))
     {
         return E_NOT_EXISTING;
     }
 
-    STM32F4xx_GPIO_RegDef_t *port = get_port_register(pin);
-    uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(pin);
-   
-    port->BSRR |= (1 << pin_number);
+    GPIOIf_handle_set(GPIOIF_HANDLE(pin));
     return E_OK;
 }
 
 std_return_type_t GPIOIf_pin_clear(GPIOIf_pin_t pin)
 {
-    if(FALSE == pin_exists( pin))
+    if(FALSE == stm32f4xx_GPIO_pin_exists(pin))
     {
         return E_NOT_EXISTING;
     }
 
-    STM32F4xx_GPIO_RegDef_t *port = get_port_register(pin);
-    uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(pin)+ 16;
-
-    port->BSRR |= (1 << pin_number);
+    GPIOIf_handle_clear(GPIOIF_HANDLE(pin));
     return E_OK;
 }
 
 std_return_type_t GPIOIf_port_set(GPIOIf_pin_t pin, uint16_t value)
 {
-    if(FALSE == pin_exists( pin))
+    if(FALSE == stm32f4xx_GPIO_port_exists(pin))
     {
         return E_NOT_EXISTING;
     }
     
     STM32F4xx_GPIO_RegDef_t *port = get_port_register(pin);
 
-    port->ODR |= value;
-    port->ODR &= (((uint32_t)0xFFFF) << 16 )| value;
-    
+    // reset all pins and set the 1-bits, set has priority in BSRR
+    port->BSRR = (((uint32_t)0xFFFF) << 16 ) | value;
+
+    return E_OK;
+}
 
-    return E_NOT_IMPLEMENTED;
+std_return_type_t GPIOIf_port_write_masked(GPIOIf_pin_t port, uint16_t mask, uint16_t value)
+{
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    // reset all masked pins and set the masked 1-bits, set has priority in BSRR
+    get_port_register(port)->BSRR = (((uint32_t) mask) << 16) | (value & mask);
+    return E_OK;
+}
+
+std_return_type_t GPIOIf_port_write_stream(GPIOIf_pin_t port, uint16_t mask, 
+                                           const uint16_t *buffer, size_t length)
+{
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+    else if(buffer == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+
+    volatile uint32_t *bsrr = &get_port_register(port)->BSRR;
+    const uint16_t *end = buffer + length;
+    uint32_t reset = ((uint32_t) mask) << 16;
+    uint32_t set = mask;
+
+    // one load, and, or and store per word, unrolled by four
+    while((size_t)(end - buffer) >= 4)
+    {
+        *bsrr = reset | (buffer[0] & set);
+        *bsrr = reset | (buffer[1] & set);
+        *bsrr = reset | (buffer[2] & set);
+        *bsrr = reset | (buffer[3] & set);
+        buffer += 4;
+    }
+
+    while(buffer < end)
+    {
+        *bsrr = reset | (*buffer++ & set);
+    }
+
+    return E_OK;
+}
+
+std_return_type_t GPIOIf_pins_write(GPIOIf_pin_t port, uint16_t set_mask, uint16_t clear_mask)
+{
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    // lower half of BSRR sets, upper half resets, set has priority
+    get_port_register(port)->BSRR = (((uint32_t) clear_mask) << 16) | set_mask;
+    return E_OK;
+}
+
+std_return_type_t GPIOIf_pins_toggle(GPIOIf_pin_t port, uint16_t mask)
+{
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    STM32F4xx_GPIO_RegDef_t *port_reg = get_port_register(port);
+    uint32_t odr = port_reg->ODR;
+
+    // reset pins which are high, set pins which are low
+    port_reg->BSRR = ((odr & mask) << 16) | (~odr & mask);
+    return E_OK;
 }
 
 std_return_type_t GPIOIf_pin_set_analog(GPIOIf_pin_t pin, uint16_t value)
@@ -353,16 +807,12 @@ std_return_type_t GPIOIf_pin_iset_analog(GPIOIf_pin_t pin, uint16_t value)
 
 boolean GPIOIf_pin_read(GPIOIf_pin_t pin)
 {
-    if(FALSE == pin_exists( pin))
+    if(FALSE == stm32f4xx_GPIO_pin_exists(pin))
     {
         return FALSE;
     }
 
-    STM32F4xx_GPIO_RegDef_t *port = get_port_register(pin);
-    uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(pin);
-
-
-    if(port->IDR & (1 << pin_number))
+    if(GPIOIf_handle_read(GPIOIF_HANDLE(pin)))
     {
         return TRUE;
     }
@@ -372,7 +822,7 @@ boolean GPIOIf_pin_read(GPIOIf_pin_t pin)
 
 std_return_type_t GPIOIf_port_read(GPIOIf_pin_t pin, uint16_t* buffer)
 {
-    if(FALSE == pin_exists( pin))
+    if(FALSE == stm32f4xx_GPIO_pin_exists(pin))
     {
         return E_NOT_EXISTING;
     }
@@ -383,244 +833,544 @@ std_return_type_t GPIOIf_port_read(GPIOIf_pin_t pin, uint16_t* buffer)
     return E_OK;
 }
 
-static boolean pin_exists(GPIOIf_pin_t pin)
-{
-    GPIOIf_pin_t pin_port = GPIOIf_get_port(pin);
+// value of a port if its clock is enabled, else 0, without a branch
+#define SNAPSHOT_PORT(value, enabled, port_number) \
+    ((uint16_t) ((value) & (0UL - (((enabled) >> (port_number)) & 0x01))))
 
-    switch (pin_port)
+std_return_type_t GPIOIf_snapshot(GPIOIf_snapshot_t *snapshot)
+{
+    if(snapshot == NULL)
     {
-    case PORT_A:
-    case PORT_B:
-    case PORT_C:
-    case PORT_D:
-    case PORT_E:
-    case PORT_H:
-        break;
-    default:
-        return FALSE;
-        break;
+        return E_VALUE_NULL;
     }
 
-    pin_port = GPIOIf_get_pin_number(pin);
-
-    if(pin_port > 0xF)
-    {
-        return FALSE;
-    }
+    uint32_t enabled = STM32F4xx_RCC->RCC_AHB1ENR.raw;
+
+    // back to back loads, nothing else is done in between
+    uint32_t start = STM32F4xx_CYCCNT();
+    uint32_t port_a = STM32F4xx_GPIOA->IDR;
+    uint32_t port_b = STM32F4xx_GPIOB->IDR;
+    uint32_t port_c = STM32F4xx_GPIOC->IDR;
+    uint32_t port_d = STM32F4xx_GPIOD->IDR;
+    uint32_t port_e = STM32F4xx_GPIOE->IDR;
+    uint32_t port_h = STM32F4xx_GPIOH->IDR;
+    uint32_t end = STM32F4xx_CYCCNT();
+
+    snapshot->ports[0] = SNAPSHOT_PORT(port_a, enabled, 0);
+    snapshot->ports[1] = SNAPSHOT_PORT(port_b, enabled, 1);
+    snapshot->ports[2] = SNAPSHOT_PORT(port_c, enabled, 2);
+    snapshot->ports[3] = SNAPSHOT_PORT(port_d, enabled, 3);
+    snapshot->ports[4] = SNAPSHOT_PORT(port_e, enabled, 4);
+    snapshot->ports[5] = 0;
+    snapshot->ports[6] = 0;
+    snapshot->ports[7] = SNAPSHOT_PORT(port_h, enabled, 7);
+    snapshot->timestamp = start;
+    snapshot->cycles = end - start;
 
-    return TRUE;
+    return E_OK;
 }
 
 static STM32F4xx_GPIO_RegDef_t *get_port_register (GPIOIf_pin_t pin)
 {
-    STM32F4xx_GPIO_RegDef_t *port;
-    
-    switch (GPIOIf_get_port(pin))
+    // port registers are spaced equally, no lookup required
+    return STM32F4xx_GPIO_PORT_REG(pin);
+}
+
+static void read_port_image(STM32F4xx_GPIO_RegDef_t *port, stm32f4xx_GPIO_port_image_t *image)
+{
+    image->MODER  = port->MODER;
+    image->OTYPER = port->OTYPER;
+    image->OSPEEDR= port->OSPEEDR;
+    image->PUPDR  = port->PUPDR;
+    image->AFRL   = port->AFRL;
+    image->AFRH   = port->AFRH;
+}
+
+static void commit_port_image(uint8_t port_number, const stm32f4xx_GPIO_port_image_t *base, 
+                              const stm32f4xx_GPIO_port_image_t *image)
+{
+    STM32F4xx_GPIO_RegDef_t *port = STM32F4xx_GPIO_PORT_REG(port_number << 8);
+    stm32f4xx_GPIO_port_image_t *shadow = &GPIO_shadows[port_number];
+
+    // alternate function, speed and pull configuration are written 
+    // before the mode to avoid glitches on the pins
+    commit_register(&shadow->AFRL,    &port->AFRL,    base->AFRL,    image->AFRL);
+    commit_register(&shadow->AFRH,    &port->AFRH,    base->AFRH,    image->AFRH);
+    commit_register(&shadow->OTYPER,  &port->OTYPER,  base->OTYPER,  image->OTYPER);
+    commit_register(&shadow->OSPEEDR, &port->OSPEEDR, base->OSPEEDR, image->OSPEEDR);
+    commit_register(&shadow->PUPDR,   &port->PUPDR,   base->PUPDR,   image->PUPDR);
+    commit_register(&shadow->MODER,   &port->MODER,   base->MODER,   image->MODER);
+}
+
+/**
+ * @brief Merges the changed bits of a register into its shadow and writes it
+ *
+ * Only the bits in which value differs from base, the shadow value the
+ * configuration was calculated from, are merged with a compare and swap,
+ * so a preempting configuration of other pins of the port is kept. The
+ * register is written from the shadow until the shadow did not change in
+ * between, i.e. the register always ends with the latest shadow value even
+ * if a preempting configuration wrote it first.
+ */
+static void commit_register(uint32_t *shadow, volatile uint32_t *reg, uint32_t base, uint32_t value)
+{
+    uint32_t changed = base ^ value;
+    uint32_t current;
+    uint32_t next;
+
+    if(changed == 0)
     {
-    case PORT_A:
-        port = STM32F4xx_GPIOA;
-        break;
-    case PORT_B:
-        port = STM32F4xx_GPIOB;
-        break;
-    case PORT_C:
-        port = STM32F4xx_GPIOC;
-        break;
-    case PORT_D:
-        port = STM32F4xx_GPIOD;
-        break;
-    case PORT_E:
-        port = STM32F4xx_GPIOE;
-        break;
-    case PORT_H:
-        port = STM32F4xx_GPIOH;
-        break;
-    default:
-        break;
+        return;
     }
 
-    return port;
+    current = __atomic_load_n(shadow, __ATOMIC_RELAXED);
+    do
+    {
+        next = (current & ~changed) | (value & changed);
+    } while(!__atomic_compare_exchange_n(shadow, &current, next, TRUE, 
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    do
+    {
+        next = __atomic_load_n(shadow, __ATOMIC_ACQUIRE);
+        *reg = next;
+    } while(__atomic_load_n(shadow, __ATOMIC_ACQUIRE) != next);
 }
 
-static void set_interrupt_register(GPIOIf_pin_t pin)
+static void write_EXTI_image(stm32f4xx_EXTI_image_t *image)
 {
-    uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(pin);
-    uint8_t shift = (pin_number & 0x3) << 2;
-    uint8_t port_number = (uint8_t) GPIOIf_get_port_number(pin);
+    uint16_t lines_changed = image->lines_enabled | image->lines_disabled;
     
-    uint32_t temp = 0x0F ^ port_number;  
-    temp = ! (temp << shift);
-    
-    STM32F4xx_SYSCFG_PCLK_EN();
-    STM32F4xx_EXTI->EXTI_IMR |= (0x01 << pin_number);
+    if(lines_changed == 0)
+    {
+        return;
+    }
 
-    // enable interrupt line
-    if(pin_number <4)
+    // register callbacks before the lines are unmasked, the interrupt of
+    // a line which is reconfigured sees either the old or the new entry
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    for(uint8_t line = 0; line < 16; line++)
     {
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR1 |= (port_number << shift);
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR1 &= temp;
+        if(image->lines_enabled & (1 << line))
+        {
+            uint8_t port_number = (image->EXTICR[line >> 2] >> ((line & 0x3) << 2)) & 0xF;
+            EXTI_pins[line] = (port_number << 8) | line;
+            EXTI_cbs[line] = image->callbacks[line];
+            EXTI_triggers[line] = (((image->RTSR >> line) & 0x01) << 1) | ((image->FTSR >> line) & 0x01);
+            // drop events of the previous configuration
+            EXTI_edges[line].tail = EXTI_edges[line].head;
+            STM32F4xx_SRAM_BITBAND(EXTI_timestamp_mask, line) = (image->lines_timestamped >> line) & 0x01;
+            STM32F4xx_SRAM_BITBAND(EXTI_deferred_mask, line) = (image->lines_deferred >> line) & 0x01;
+            STM32F4xx_SRAM_BITBAND(EXTI_event_mask, line) = (image->lines_event >> line) & 0x01;
+            STM32F4xx_SRAM_BITBAND(EXTI_mask, line) = (image->IMR >> line) & 0x01;
+        }
     }
-    else if(pin_number <8)
+    stm32f4xx_critical_exit(critical);
+
+    if(image->lines_timestamped)
     {
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR2 |= (port_number << shift);
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR2 &= temp;
+        STM32F4xx_CYCCNT_ENABLE();
     }
-    else if(pin_number <12)
+
+    if(image->lines_enabled)
     {
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR3 |= (port_number << shift);
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR3 &= temp;
+        // only the port selections of the configured lines are merged, 
+        // words without a changed line are not written
+        STM32F4xx_SYSCFG_PCLK_EN();
+        commit_register(&EXTICR_shadows[0], &STM32F4xx_SYSCFG->SYSCFG_EXTICR1, image->EXTICR_bases[0], image->EXTICR[0]);
+        commit_register(&EXTICR_shadows[1], &STM32F4xx_SYSCFG->SYSCFG_EXTICR2, image->EXTICR_bases[1], image->EXTICR[1]);
+        commit_register(&EXTICR_shadows[2], &STM32F4xx_SYSCFG->SYSCFG_EXTICR3, image->EXTICR_bases[2], image->EXTICR[2]);
+        commit_register(&EXTICR_shadows[3], &STM32F4xx_SYSCFG->SYSCFG_EXTICR4, image->EXTICR_bases[3], image->EXTICR[3]);
     }
-    else
+
+    // only the changed lines are written, each with a single bit-band
+    // store, so lines owned by other drivers (e.g. RTC alarm) can not be
+    // lost to a preempting read-modify-write
+    for(uint8_t line = 0; line < 16; line++)
     {
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR4 |= (port_number << shift);
-        STM32F4xx_SYSCFG->SYSCFG_EXTICR4 &= temp;
+        if((lines_changed & (1 << line)) == 0)
+        {
+            continue;
+        }
+        STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_RTSR, line) = (image->RTSR >> line) & 0x01;
+        STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_FTSR, line) = (image->FTSR >> line) & 0x01;
+        STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_IMR, line)  = (image->IMR >> line) & 0x01;
+        STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_EMR, line)  = (image->EMR >> line) & 0x01;
+
+        if(image->lines_disabled & (1 << line))
+        {
+            STM32F4xx_SRAM_BITBAND(EXTI_mask, line) = 0;
+            STM32F4xx_SRAM_BITBAND(EXTI_timestamp_mask, line) = 0;
+            STM32F4xx_SRAM_BITBAND(EXTI_deferred_mask, line) = 0;
+            STM32F4xx_SRAM_BITBAND(EXTI_event_mask, line) = 0;
+        }
     }
 
-    switch (pin_number)
+    // lines 5-9 and 10-15 share one IRQ, the last line configured 
+    // sets its priority
+    for(uint8_t line = 0; line < 16; line++)
     {
-    case 0:
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI0_IRQ);
-        break;
-    case 1:
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI1_IRQ);
-        break;
-    case 2:
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI2_IRQ);
-        break;
-    case 3:
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI3_IRQ);
-        break;
-    case 4:
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI4_IRQ);
-        break;
-    case 5:
-    case 6:
-    case 7:
-    case 8:
-    case 9:
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI9_5_IRQ);
-        break;
-    case 10:
-    case 11:
-    case 12:
-    case 13:
-    case 14:
-    case 15:
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI15_10_IRQ);
-        break;
-    default:
-        break;
-    } 
-}   
+        if(image->lines_enabled & image->lines_prioritized & (1 << line))
+        {
+            stm32f4xx_set_interrupt_priority(EXTI_irqs[line], image->priorities[line]);
+        }
+    }
 
-static void clear_interrupt_register(GPIOIf_pin_t pin)
-{
-    uint8_t pin_number = (uint8_t) GPIOIf_get_pin_number(pin);
-    
-    STM32F4xx_EXTI->EXTI_IMR &= ~(0x01 << pin_number);
+    // enable each IRQ which serves at least one active line, 
+    // disable it once all of its lines are released
+    uint16_t irq_lines_done = 0;
+    for(uint8_t line = 0; line < 16; line++)
+    {
+        uint16_t irq_lines = EXTI_irq_lines[line];
+        if((lines_changed & (1 << line)) == 0 || (irq_lines_done & irq_lines))
+        {
+            continue;
+        }
+        irq_lines_done |= irq_lines;
+
+        if(EXTI_mask & irq_lines)
+        {
+            stm32f4xx_enable_irq(EXTI_irqs[line]);
+        }
+        else
+        {
+            stm32f4xx_disable_irq(EXTI_irqs[line]);
+        }
+    }
 
-    switch (pin_number)
+    for(uint8_t line = 0; line < 16; line++)
     {
-    case 0:
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI0_IRQ);
-        break;
-    case 1:
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI1_IRQ);
-        break;
-    case 2:
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI2_IRQ);
-        break;
-    case 3:
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI3_IRQ);
-        break;
-    case 4:
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI4_IRQ);
-        break;
-    case 5:
-    case 6:
-    case 7:
-    case 8:
-    case 9:
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI9_5_IRQ);
-        break;
-    case 10:
-    case 11:
-    case 12:
-    case 13:
-    case 14:
-    case 15:
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI15_10_IRQ);
-        break;
-    default:
-        break;
-    } 
-}   
+        if(image->lines_disabled & (1 << line))
+        {
+            EXTI_cbs[line] = 0UL;
+        }
+    }
+}
 
-void EXTI0_Handler(void)
+
+boolean GPIOIf_get_edge_event(GPIOIf_pin_t pin, GPIOIf_edge_event_t *event)
 {
-    STM32F4xx_EXTI->EXTI_PR |= ( 0x01 );
-    if(EXTI_mask & 1 )
+    if(event == NULL || FALSE == stm32f4xx_GPIO_pin_exists(pin))
+    {
+        return FALSE;
+    }
+
+    uint8_t line = (uint8_t) GPIOIf_get_pin_number(pin);
+    stm32f4xx_edge_buffer_t *buffer = &EXTI_edges[line];
+
+    if(EXTI_pins[line] != pin || (EXTI_timestamp_mask & (1UL << line)) == 0)
+    {
+        return FALSE;
+    }
+
+    uint32_t tail = buffer->tail;
+    // acquire: the event is read after the head which published it
+    if(__atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE) == tail)
     {
-        EXTI_cbs[0]();
+        return FALSE;
     }
-    else
+
+    *event = buffer->events[tail & (STM32F4xx_GPIO_EDGE_BUFFER_SIZE - 1)];
+    // release: the slot is handed back after it has been copied
+    __atomic_store_n(&buffer->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return TRUE;
+}
+
+/**
+ * @brief Stores an edge event of a line, called from the EXTI interrupt
+ *
+ * If the buffer is full the event is dropped.
+ */
+static inline __attribute__((always_inline)) void push_edge_event(uint32_t line, uint32_t timestamp)
+{
+    stm32f4xx_edge_buffer_t *buffer = &EXTI_edges[line];
+    uint32_t head = buffer->head;
+
+    if(head - __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE) >= STM32F4xx_GPIO_EDGE_BUFFER_SIZE)
     {
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI0_IRQ);
-    }    
+        return;
+    }
+
+    GPIOIf_edge_event_t *event = &buffer->events[head & (STM32F4xx_GPIO_EDGE_BUFFER_SIZE - 1)];
+    GPIOIf_pin_t pin = EXTI_pins[line];
+    event->timestamp = timestamp;
+    event->pin = pin;
+    event->level = (STM32F4xx_GPIO_PORT_REG(pin)->IDR >> line) & 0x01;
+
+    // release: the event is complete before it is published
+    __atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
 }
 
-void EXTI1_Handler(void)
+uint32_t GPIOIf_process_events(void)
 {
-    uint8_t id = ( 0x01 << 1);
-    STM32F4xx_EXTI->EXTI_PR |= id;
-    if(EXTI_mask & id )
+    uint32_t tail = EXTI_events.tail;
+    uint32_t count = 0;
+
+    while(1)
     {
-        EXTI_cbs[1]();
+        stm32f4xx_event_slot_t *slot = &EXTI_events.slots[tail & (STM32F4xx_GPIO_EVENT_QUEUE_SIZE - 1)];
+        // acquire: the slot is read after the info word which published it
+        uint32_t info = __atomic_load_n(&slot->info, __ATOMIC_ACQUIRE);
+        if(info == 0)
+        {
+            break;
+        }
+
+        void (*callback)(void) = slot->callback;
+
+        // hand the slot back before the callback runs, so the callback 
+        // does not extend the time the slot is blocked
+        slot->info = 0;
+        tail++;
+        __atomic_store_n(&EXTI_events.tail, tail, __ATOMIC_RELEASE);
+        count++;
+
+        if(callback != NULL)
+        {
+            callback();
+        }
     }
-    else
+
+    return count;
+}
+
+static void process_events_work(void *context)
+{
+    (void) context;
+
+    // edges queued from now on post a new item
+    __atomic_store_n(&EXTI_events_posted, FALSE, __ATOMIC_RELAXED);
+    (void) GPIOIf_process_events();
+}
+
+/**
+ * @brief Queues an edge of a line, called from the EXTI interrupt
+ *
+ * A slot is reserved with a compare and swap on head, so nested EXTI 
+ * interrupts of higher priority can queue edges at any time. If the queue 
+ * is full the edge is dropped. The callbacks run from the deferred work 
+ * queue at the lowest interrupt priority.
+ */
+static inline __attribute__((always_inline)) void push_deferred_event(uint32_t line)
+{
+    uint32_t head = __atomic_load_n(&EXTI_events.head, __ATOMIC_RELAXED);
+
+    do
     {
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI1_IRQ);
-    }    
+        if(head - __atomic_load_n(&EXTI_events.tail, __ATOMIC_ACQUIRE) >= STM32F4xx_GPIO_EVENT_QUEUE_SIZE)
+        {
+            return;
+        }
+    } while(!__atomic_compare_exchange_n(&EXTI_events.head, &head, head + 1, TRUE, 
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    stm32f4xx_event_slot_t *slot = &EXTI_events.slots[head & (STM32F4xx_GPIO_EVENT_QUEUE_SIZE - 1)];
+
+    slot->callback = EXTI_cbs[line];
+    // release: the slot is complete before it is published
+    __atomic_store_n(&slot->info, STM32F4xx_GPIO_EVENT_VALID | line, __ATOMIC_RELEASE);
+
+    // one work item drains all queued edges, at most one is queued at a 
+    // time, so the reserved slot of the work queue is always free for it
+    if(__atomic_exchange_n(&EXTI_events_posted, TRUE, __ATOMIC_RELAXED) == FALSE)
+    {
+        (void) stm32f4xx_defer_reserved_work(process_events_work, NULL);
+    }
 }
 
-void EXTI2_Handler(void)
+std_return_type_t GPIOIf_signal_register(uint8_t signal, void (*handler)(void), uint8_t priority)
 {
-    uint8_t id = ( 0x01 << 2);
-    STM32F4xx_EXTI->EXTI_PR |= id;
-    if(EXTI_mask & id )
+    if(signal >= STM32F4xx_EXTI_LINES || ((STM32F4xx_GPIO_SIGNAL_LINES >> signal) & 0x01) == 0)
     {
-        EXTI_cbs[2]();
+        return E_NOT_EXISTING;
     }
-    else
+    if(handler == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+
+    uint32_t line = 1UL << signal;
+    // the line is claimed without preemption by another registration
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    if(((EXTI_mask & ~EXTI_signal_mask) | EXTI_event_mask) & line)
     {
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI2_IRQ);
-    }    
+        stm32f4xx_critical_exit(critical);
+        return E_STATE_ERR;
+    }
+
+    std_return_type_t status = stm32f4xx_set_interrupt_priority(EXTI_irqs[signal], priority);
+    if(status != E_OK)
+    {
+        stm32f4xx_critical_exit(critical);
+        return status;
+    }
+    if(EXTI_signal_handlers[signal] != NULL)
+    {
+        status = stm32f4xx_register_irq_handler(EXTI_irqs[signal], EXTI_signal_handlers[signal]);
+        if(status != E_OK)
+        {
+            stm32f4xx_critical_exit(critical);
+            return status;
+        }
+    }
+
+    // register the handler before the line is unmasked, the line has no
+    // edge trigger, only SWIER sets it pending
+    EXTI_cbs[signal] = handler;
+    STM32F4xx_SRAM_BITBAND(EXTI_signal_mask, signal) = 1;
+    STM32F4xx_SRAM_BITBAND(EXTI_mask, signal) = 1;
+    STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_RTSR, signal) = 0;
+    STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_FTSR, signal) = 0;
+    STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_EMR, signal) = 0;
+    STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_IMR, signal) = 1;
+    stm32f4xx_enable_irq(EXTI_irqs[signal]);
+    stm32f4xx_critical_exit(critical);
+
+    return E_OK;
 }
 
-void EXTI3_Handler(void)
+std_return_type_t GPIOIf_signal_unregister(uint8_t signal)
 {
-    uint8_t id = ( 0x01 << 3);
-    STM32F4xx_EXTI->EXTI_PR |= id;
-    if(EXTI_mask & id )
+    if(signal >= STM32F4xx_EXTI_LINES)
     {
-        EXTI_cbs[3]();
+        return E_STATE_NOINIT;
     }
-    else
+
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    if((EXTI_signal_mask & (1UL << signal)) == 0)
     {
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI3_IRQ);
-    }    
+        stm32f4xx_critical_exit(critical);
+        return E_STATE_NOINIT;
+    }
+
+    STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_IMR, signal) = 0;
+    STM32F4xx_EXTI->EXTI_PR = (1UL << signal);
+    STM32F4xx_SRAM_BITBAND(EXTI_mask, signal) = 0;
+    STM32F4xx_SRAM_BITBAND(EXTI_signal_mask, signal) = 0;
+
+    if((EXTI_mask & EXTI_irq_lines[signal]) == 0)
+    {
+        stm32f4xx_disable_irq(EXTI_irqs[signal]);
+    }
+    if(EXTI_signal_handlers[signal] != NULL)
+    {
+        (void) stm32f4xx_restore_irq_handler(EXTI_irqs[signal]);
+    }
+    EXTI_cbs[signal] = 0UL;
+    stm32f4xx_critical_exit(critical);
+
+    return E_OK;
 }
 
-void EXTI4_Handler(void)
+/**
+ * @brief Serves all pending lines of one EXTI interrupt
+ *
+ * PR is read once and every pending line of the group is acknowledged
+ * with a single write (PR is write-1-to-clear). The callbacks of the
+ * registered lines are called lowest line first, so simultaneous edges
+ * are served within one ISR entry. If no line of the group is
+ * registered anymore the interrupt is disabled. The timestamp is taken
+ * by the handler before anything else and is shared by all lines which
+ * are served in this ISR entry.
+ */
+static inline __attribute__((always_inline)) void dispatch_EXTI(uint32_t group, STM32F4xx_IRQ_t irq, uint32_t timestamp)
 {
-    uint8_t id = ( 0x01 << 4);
-    STM32F4xx_EXTI->EXTI_PR |= id;
-    if(EXTI_mask & id )
+    uint32_t pending = STM32F4xx_EXTI->EXTI_PR & group;
+    STM32F4xx_EXTI->EXTI_PR = pending;
+
+    uint32_t active = pending & EXTI_mask;
+    if((EXTI_mask & group) == 0)
     {
-        EXTI_cbs[4]();
+        stm32f4xx_disable_irq(irq);
     }
-    else
+
+    while(active)
     {
-        stm32f4xx_disable_interrupt(STM32F4xx_EXTI4_IRQ);
-    }    
+        uint32_t line = __builtin_ctz(active);
+        active &= active - 1;   // clear lowest set bit
+
+        if(EXTI_timestamp_mask & (1UL << line))
+        {
+            push_edge_event(line, timestamp);
+        }
+        if(EXTI_deferred_mask & (1UL << line))
+        {
+            push_deferred_event(line);
+        }
+        else if(EXTI_cbs[line] != NULL)
+        {
+            EXTI_cbs[line]();
+        }
+    }
+}
+
+STM32F4xx_ISR_RAMFUNC void EXTI0_Handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x0001, STM32F4xx_EXTI0_IRQ, timestamp);
+}
+
+STM32F4xx_ISR_RAMFUNC void EXTI1_Handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x0002, STM32F4xx_EXTI1_IRQ, timestamp);
+}
+
+STM32F4xx_ISR_RAMFUNC void EXTI2_Handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x0004, STM32F4xx_EXTI2_IRQ, timestamp);
+}
+
+STM32F4xx_ISR_RAMFUNC void EXTI3_Handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x0008, STM32F4xx_EXTI3_IRQ, timestamp);
+}
+
+STM32F4xx_ISR_RAMFUNC void EXTI4_Handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x0010, STM32F4xx_EXTI4_IRQ, timestamp);
+}
+
+STM32F4xx_ISR_RAMFUNC void EXTI9_5_Handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x03E0, STM32F4xx_EXTI9_5_IRQ, timestamp);
+}
+
+STM32F4xx_ISR_RAMFUNC void EXTI15_10_Handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0xFC00, STM32F4xx_EXTI15_10_IRQ, timestamp);
+}
+
+// lines 16, 18, 21 and 22 are only used as software signals, their 
+// handlers are installed by GPIOIf_signal_register() and the weak 
+// handlers of the vector table are kept otherwise
+
+static STM32F4xx_ISR_RAMFUNC void EXTI16_signal_handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x10000, STM32F4xx_EXTI16_PVD_IRQ, timestamp);
+}
+
+static STM32F4xx_ISR_RAMFUNC void EXTI18_signal_handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x40000, STM32F4xx_EXTI18_OTG_FS_WKUP_IRQ, timestamp);
+}
+
+static STM32F4xx_ISR_RAMFUNC void EXTI21_signal_handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x200000, STM32F4xx_EXTI21_TAMP_STAMP_IRQ, timestamp);
+}
+
+static STM32F4xx_ISR_RAMFUNC void EXTI22_signal_handler(void)
+{
+    uint32_t timestamp = STM32F4xx_CYCCNT();
+    dispatch_EXTI(0x400000, STM32F4xx_EXTI22_RTC_WKUP_IRQ, timestamp);
 }
@@ -0,0 +1,152 @@
+/**
+ * @file stm32f4xx_GPIOIf.h
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx inline fast path for GPIO access
+ *
+ * This file provides pin handles for the STM32F4xx series. A
+ * handle is resolved at compile time from the PIN_x_yy constants
+ * into the port base address and the bit mask of the pin, so the
+ * inline operations below compile down to a single BSRR or IDR
+ * access. The handles are not validated, use GPIOIf_config_pin()
+ * to check a pin once during initialization.
+ */
+
+#ifndef STM32F4XX_GPIOIF_H
+#define STM32F4XX_GPIOIF_H
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "stm32f4xx.h"
+
+// GPIO ports are mapped in steps of 0x400 starting with GPIOA, the
+// high byte of the pin identifier is the port number (A=0 ... H=7)
+#define STM32F4xx_GPIO_PORT_ADDR(pin)   (_MMIO_ADDR_GPIOA + (((uint32_t) GPIOIf_get_port_number(pin)) << 10))
+#define STM32F4xx_GPIO_PORT_REG(pin)    ((STM32F4xx_GPIO_RegDef_t* ) STM32F4xx_GPIO_PORT_ADDR(pin))
+#define STM32F4xx_GPIO_PIN_MASK(pin)    ((uint16_t) (1UL << GPIOIf_get_pin_number(pin)))
+
+// available ports as bitmap of port numbers: A-E (0-4) and H (7)
+#define STM32F4xx_GPIO_AVAILABLE_PORTS  0x9F
+
+/**
+ * @brief Checks if a port exists
+ *
+ * Accepts the port identifier as well as any pin of the port, lookup in
+ * the bitmap of available ports.
+ */
+STM32F4xx_ALWAYS_INLINE boolean stm32f4xx_GPIO_port_exists(GPIOIf_pin_t port)
+{
+    uint32_t port_number = GPIOIf_get_port_number(port);
+
+    return (port_number < 8 && ((STM32F4xx_GPIO_AVAILABLE_PORTS >> port_number) & 0x1)) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Checks if a pin exists
+ */
+STM32F4xx_ALWAYS_INLINE boolean stm32f4xx_GPIO_pin_exists(GPIOIf_pin_t pin)
+{
+    return (stm32f4xx_GPIO_port_exists(pin) == TRUE && GPIOIf_get_pin_number(pin) <= 0xF) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Resolved pin handle
+ *
+ * Contains the register set of the port and the bit mask
+ * of the pin inside the port.
+ */
+typedef struct __GPIOIf_handle
+{
+    STM32F4xx_GPIO_RegDef_t *port;      // register set of the port
+    uint16_t mask;                      // bit mask of the pin
+} GPIOIf_handle_t;
+
+// initializer for static/const handles, e.g.
+// static const GPIOIf_handle_t led = GPIOIF_HANDLE_INIT(PIN_A_05);
+#define GPIOIF_HANDLE_INIT(pin)     { STM32F4xx_GPIO_PORT_REG(pin), STM32F4xx_GPIO_PIN_MASK(pin) }
+// handle as expression, e.g. GPIOIf_handle_set(GPIOIF_HANDLE(PIN_A_05));
+#define GPIOIF_HANDLE(pin)          ((GPIOIf_handle_t) GPIOIF_HANDLE_INIT(pin))
+
+/**
+ * @brief Sets a pin
+ *
+ * Single write-only store to the set half of BSRR.
+ */
+STM32F4xx_ALWAYS_INLINE void GPIOIf_handle_set(GPIOIf_handle_t pin)
+{
+    pin.port->BSRR = pin.mask;
+}
+
+/**
+ * @brief Clears a pin
+ *
+ * Single write-only store to the reset half of BSRR.
+ */
+STM32F4xx_ALWAYS_INLINE void GPIOIf_handle_clear(GPIOIf_handle_t pin)
+{
+    pin.port->BSRR = ((uint32_t) pin.mask) << 16;
+}
+
+/**
+ * @brief Toggles a pin
+ *
+ * Reads ODR once and writes set and reset half of BSRR with a
+ * single store, other pins of the port are not touched.
+ */
+STM32F4xx_ALWAYS_INLINE void GPIOIf_handle_toggle(GPIOIf_handle_t pin)
+{
+    uint32_t odr = pin.port->ODR;
+    pin.port->BSRR = ((odr & pin.mask) << 16) | (~odr & pin.mask);
+}
+
+/**
+ * @brief Reads a pin
+ *
+ * Single load of IDR, returns 0 if the pin is low and non-zero
+ * if it is high.
+ */
+STM32F4xx_ALWAYS_INLINE uint32_t GPIOIf_handle_read(GPIOIf_handle_t pin)
+{
+    return pin.port->IDR & pin.mask;
+}
+
+// external interrupt lines which can be used as software signal: the pin
+// lines 0-15 and the lines 16 (PVD), 18 (USB OTG FS wakeup), 21 (tamper
+// and timestamp) and 22 (RTC wakeup), which have an interrupt of their
+// own. The handler of such an interrupt is installed while the signal is
+// registered, which relocates the vector table to SRAM. Line 17 is used
+// by the RTC alarm.
+#define STM32F4xx_GPIO_SIGNAL_LINES     0x0065FFFFUL
+
+/**
+ * @brief Raises a software signal
+ *
+ * Single store to SWIER, which sets the pending bit of the line. Writing 
+ * 0 to the other bits has no effect. The signal is not validated, it 
+ * shall be registered with GPIOIf_signal_register() once during 
+ * initialization. Several raises before the handler runs are served once.
+ */
+STM32F4xx_ALWAYS_INLINE void GPIOIf_signal_raise(uint8_t signal)
+{
+    STM32F4xx_EXTI->EXTI_SWIER = 1UL << signal;
+}
+
+/**
+ * @brief Sleeps until the next wakeup event
+ *
+ * Executes WFE. The core resumes directly after the instruction on an 
+ * edge of a pin configured with GPIOIF_EXTI_EVENT, without vectoring to
+ * an interrupt handler. WFE also returns on any interrupt and on events
+ * which occurred since the last WFE, so it shall be called in a loop 
+ * which checks the awaited condition before each call, e.g.
+ * while(GPIOIf_handle_read(pin) == 0) { GPIOIf_wait_for_event(); }
+ * An edge between the check and WFE is not lost, it lets WFE return 
+ * immediately.
+ */
+STM32F4xx_ALWAYS_INLINE void GPIOIf_wait_for_event(void)
+{
+    __asm volatile ("wfe" ::: "memory");
+}
+
+#endif
@@ -0,0 +1,449 @@
+/**
+ * @file stm32f4xx_GPIOIf_dma.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx DMA based streaming of GPIO ports
+ *
+ * This file implements the timer paced DMA transfers of the
+ * generic GPIO API for the STM32F4xx series. Only DMA2 can access
+ * the GPIO ports on the AHB1 bus, its timer requests are served
+ * by TIM1 (TIM8 is not available on all devices), so TIM1 is used
+ * as time base and only one transfer can run at a time.
+ *
+ * Waveform: TIM1 update -> DMA2 stream 5 channel 6 -> GPIOx_BSRR
+ * Capture:  TIM1 CC1    -> DMA2 stream 1 channel 6 <- GPIOx_IDR
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "SysClockIf.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_interrupt.h"
+
+#define STM32F4xx_WAVEFORM_STREAM       5
+#define STM32F4xx_WAVEFORM_CHANNEL      6       // TIM1_UP
+#define STM32F4xx_CAPTURE_STREAM        1
+#define STM32F4xx_CAPTURE_CHANNEL       6       // TIM1_CH1
+
+typedef enum _stm32f4xx_GPIO_dma_owner
+{
+    STM32F4xx_GPIO_DMA_IDLE         = 0x00,
+    STM32F4xx_GPIO_DMA_WAVEFORM     = 0x01,
+    STM32F4xx_GPIO_DMA_CAPTURE      = 0x02,
+} stm32f4xx_GPIO_dma_owner_t;
+
+typedef struct _stm32f4xx_waveform
+{
+    GPIOIf_waveform_callback_t callback;
+    size_t length;
+    boolean last_buffer;                            // no buffer is refilled anymore
+} stm32f4xx_waveform_t;
+
+typedef struct _stm32f4xx_capture
+{
+    GPIOIf_capture_config_t cfg;
+    size_t runs_count;                              // completed runs in the run buffer
+    uint16_t run_value;                             // value of the open run
+    uint16_t run_length;                            // length of the open run, 0 if none
+} stm32f4xx_capture_t;
+
+static char timer_clock[] = "APB2 Timer";
+
+static volatile stm32f4xx_GPIO_dma_owner_t dma_owner = STM32F4xx_GPIO_DMA_IDLE;
+static stm32f4xx_waveform_t waveform = {};
+static stm32f4xx_capture_t capture = {};
+
+static std_return_type_t set_timer_rate(STM32F4xx_TIM_RegDef_t *timer, uint32_t rate);
+static void disable_stream(STM32F4xx_DMA_Stream_RegDef_t *stream);
+static void stop_waveform(void);
+static uint32_t stop_capture(void);
+static void compress_samples(const uint16_t *samples, size_t count);
+static void flush_runs(void);
+
+std_return_type_t GPIOIf_waveform_start(GPIOIf_pin_t port, uint32_t rate, uint32_t *buffer_0,
+                                        uint32_t *buffer_1, size_t length,
+                                        GPIOIf_waveform_callback_t callback)
+{
+    STM32F4xx_DMA_Stream_RegDef_t *stream = &STM32F4xx_DMA2->STREAM[STM32F4xx_WAVEFORM_STREAM];
+
+    if(FALSE == stm32f4xx_GPIO_port_exists(port))
+    {
+        return E_NOT_EXISTING;
+    }
+    if(buffer_0 == NULL || (buffer_1 != NULL && callback == NULL))
+    {
+        return E_VALUE_NULL;
+    }
+    if(length == 0 || length > 0xFFFF)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+    if(dma_owner != STM32F4xx_GPIO_DMA_IDLE)
+    {
+        return E_STATE_ERR;
+    }
+
+    STM32F4xx_TIM1_PCLK_EN();
+    STM32F4xx_DMA2_PCLK_EN();
+
+    STM32F4xx_TIM1->CR1 = 0;
+    std_return_type_t status = set_timer_rate(STM32F4xx_TIM1, rate);
+    if(status != E_OK)
+    {
+        return status;
+    }
+
+    dma_owner = STM32F4xx_GPIO_DMA_WAVEFORM;
+    waveform.callback = callback;
+    waveform.length = length;
+    waveform.last_buffer = FALSE;
+
+    disable_stream(stream);
+    STM32F4xx_DMA2->HIFCR = STM32F4xx_DMA_FLAG_ALL << STM32F4xx_DMA_FLAG_SHIFT(STM32F4xx_WAVEFORM_STREAM);
+
+    stream->PAR  = (uint32_t) (uintptr_t) &STM32F4xx_GPIO_PORT_REG(port)->BSRR;
+    stream->M0AR = (uint32_t) (uintptr_t) buffer_0;
+    stream->M1AR = (uint32_t) (uintptr_t) buffer_1;
+    stream->NDTR = length;
+    // the FIFO prefetches the next words, so the store to BSRR does not
+    // wait on the memory read after each timer request
+    stream->FCR  = STM32F4xx_DMA_FCR_DMDIS | STM32F4xx_DMA_FCR_FTH_FULL;
+    stream->CR   = STM32F4xx_DMA_CR_CHSEL(STM32F4xx_WAVEFORM_CHANNEL)
+                 | STM32F4xx_DMA_CR_PL_VERY_HIGH
+                 | STM32F4xx_DMA_CR_MSIZE_32 | STM32F4xx_DMA_CR_PSIZE_32
+                 | STM32F4xx_DMA_CR_MINC | STM32F4xx_DMA_CR_DIR_M2P
+                 | STM32F4xx_DMA_CR_TCIE | STM32F4xx_DMA_CR_TEIE;
+    if(buffer_1 != NULL)
+    {
+        stream->CR |= STM32F4xx_DMA_CR_DBM | STM32F4xx_DMA_CR_CIRC;
+    }
+    stream->CR |= STM32F4xx_DMA_CR_EN;
+
+    stm32f4xx_enable_irq(STM32F4xx_DMA2_STREAM5_IRQ);
+
+    // each update event requests the next word
+    STM32F4xx_TIM1->DIER = STM32F4xx_TIM_DIER_UDE;
+    STM32F4xx_TIM1->CR1 = STM32F4xx_TIM_CR1_ARPE | STM32F4xx_TIM_CR1_CEN;
+
+    return E_OK;
+}
+
+std_return_type_t GPIOIf_waveform_stop(void)
+{
+    if(dma_owner != STM32F4xx_GPIO_DMA_WAVEFORM)
+    {
+        return E_STATE_NOINIT;
+    }
+
+    stop_waveform();
+
+    return E_OK;
+}
+
+void DMA2_STREAM5_Handler(void)
+{
+    STM32F4xx_DMA_Stream_RegDef_t *stream = &STM32F4xx_DMA2->STREAM[STM32F4xx_WAVEFORM_STREAM];
+    uint32_t shift = STM32F4xx_DMA_FLAG_SHIFT(STM32F4xx_WAVEFORM_STREAM);
+    uint32_t flags = (STM32F4xx_DMA2->HISR >> shift) & STM32F4xx_DMA_FLAG_ALL;
+
+    STM32F4xx_DMA2->HIFCR = flags << shift;
+
+    if((flags & STM32F4xx_DMA_FLAG_TE) || (stream->CR & STM32F4xx_DMA_CR_DBM) == 0 || waveform.last_buffer == TRUE)
+    {
+        stop_waveform();
+        if(waveform.callback != NULL)
+        {
+            (void) waveform.callback(NULL, 0);
+        }
+        return;
+    }
+
+    if(flags & STM32F4xx_DMA_FLAG_TC)
+    {
+        // CT selects the buffer which is output now, the other one is done
+        uint32_t *buffer = (uint32_t *) (uintptr_t) ((stream->CR & STM32F4xx_DMA_CR_CT) ? stream->M0AR : stream->M1AR);
+
+        if(FALSE == waveform.callback(buffer, waveform.length))
+        {
+            // the stream switches to this buffer again before the next
+            // interrupt is served, words of 0 do not change the port
+            for(size_t i = 0; i < waveform.length; i++)
+            {
+                buffer[i] = 0;
+            }
+            waveform.last_buffer = TRUE;
+        }
+    }
+}
+
+std_return_type_t GPIOIf_capture_start(const GPIOIf_capture_config_t *cfg)
+{
+    STM32F4xx_DMA_Stream_RegDef_t *stream = &STM32F4xx_DMA2->STREAM[STM32F4xx_CAPTURE_STREAM];
+
+    if(cfg == NULL || cfg->buffer == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+    if(FALSE == stm32f4xx_GPIO_port_exists(cfg->port))
+    {
+        return E_NOT_EXISTING;
+    }
+    if((cfg->mode == GPIOIF_CAPTURE_RAW && (cfg->half_callback == NULL || cfg->full_callback == NULL)) ||
+       (cfg->mode == GPIOIF_CAPTURE_RLE && (cfg->runs == NULL || cfg->run_callback == NULL)))
+    {
+        return E_VALUE_NULL;
+    }
+    if(cfg->mode != GPIOIF_CAPTURE_RAW && cfg->mode != GPIOIF_CAPTURE_RLE)
+    {
+        return E_NOT_SUPPORTED;
+    }
+    if(cfg->length < 2 || cfg->length > 0xFFFF || (cfg->length & 0x1) || 
+       (cfg->mode == GPIOIF_CAPTURE_RLE && cfg->runs_length == 0))
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+    if(dma_owner != STM32F4xx_GPIO_DMA_IDLE)
+    {
+        return E_STATE_ERR;
+    }
+
+    STM32F4xx_TIM1_PCLK_EN();
+    STM32F4xx_DMA2_PCLK_EN();
+
+    STM32F4xx_TIM1->CR1 = 0;
+    std_return_type_t status = set_timer_rate(STM32F4xx_TIM1, cfg->rate);
+    if(status != E_OK)
+    {
+        return status;
+    }
+
+    dma_owner = STM32F4xx_GPIO_DMA_CAPTURE;
+    capture.cfg = *cfg;
+    capture.runs_count = 0;
+    capture.run_length = 0;
+
+    disable_stream(stream);
+    STM32F4xx_DMA2->LIFCR = STM32F4xx_DMA_FLAG_ALL << STM32F4xx_DMA_FLAG_SHIFT(STM32F4xx_CAPTURE_STREAM);
+
+    stream->PAR  = (uint32_t) (uintptr_t) &STM32F4xx_GPIO_PORT_REG(cfg->port)->IDR;
+    stream->M0AR = (uint32_t) (uintptr_t) cfg->buffer;
+    stream->NDTR = cfg->length;
+    // direct mode, each sample is stored as soon as it is read
+    stream->FCR  = 0;
+    stream->CR   = STM32F4xx_DMA_CR_CHSEL(STM32F4xx_CAPTURE_CHANNEL)
+                 | STM32F4xx_DMA_CR_PL_VERY_HIGH
+                 | STM32F4xx_DMA_CR_MSIZE_16 | STM32F4xx_DMA_CR_PSIZE_16
+                 | STM32F4xx_DMA_CR_MINC | STM32F4xx_DMA_CR_DIR_P2M | STM32F4xx_DMA_CR_CIRC
+                 | STM32F4xx_DMA_CR_HTIE | STM32F4xx_DMA_CR_TCIE | STM32F4xx_DMA_CR_TEIE;
+    stream->CR |= STM32F4xx_DMA_CR_EN;
+
+    stm32f4xx_enable_irq(STM32F4xx_DMA2_STREAM1_IRQ);
+
+    // channel 1 is a frozen output compare at counter value 0, i.e. it 
+    // requests one sample per timer period without driving a pin
+    STM32F4xx_TIM1->CCMR1 = 0;
+    STM32F4xx_TIM1->CCER = 0;
+    STM32F4xx_TIM1->CCR1 = 0;
+    STM32F4xx_TIM1->DIER = STM32F4xx_TIM_DIER_CCDE(1);
+    STM32F4xx_TIM1->CR1 = STM32F4xx_TIM_CR1_ARPE | STM32F4xx_TIM_CR1_CEN;
+
+    return E_OK;
+}
+
+std_return_type_t GPIOIf_capture_stop(void)
+{
+    if(dma_owner != STM32F4xx_GPIO_DMA_CAPTURE)
+    {
+        return E_STATE_NOINIT;
+    }
+
+    uint32_t flags = stop_capture();
+    uint32_t remaining = STM32F4xx_DMA2->STREAM[STM32F4xx_CAPTURE_STREAM].NDTR;
+
+    if(capture.cfg.mode == GPIOIF_CAPTURE_RLE)
+    {
+        // NDTR of the disabled stream holds the samples which were left of
+        // the buffer, it is reloaded with length when the buffer wraps
+        size_t half = capture.cfg.length >> 1;
+        size_t position = capture.cfg.length - remaining;
+        uint8_t part = (position >= half) ? 1 : 0;
+
+        // the previous half is completed, but its interrupt was not served
+        if(flags & (part == 0 ? STM32F4xx_DMA_FLAG_TC : STM32F4xx_DMA_FLAG_HT))
+        {
+            compress_samples(&capture.cfg.buffer[(1 - part) * half], half);
+        }
+        compress_samples(&capture.cfg.buffer[part * half], position - part * half);
+
+        // close the open run
+        if(capture.run_length != 0)
+        {
+            capture.cfg.runs[capture.runs_count].value = capture.run_value;
+            capture.cfg.runs[capture.runs_count].length = capture.run_length;
+            capture.runs_count++;
+            capture.run_length = 0;
+        }
+        flush_runs();
+    }
+
+    return E_OK;
+}
+
+void DMA2_STREAM1_Handler(void)
+{
+    uint32_t shift = STM32F4xx_DMA_FLAG_SHIFT(STM32F4xx_CAPTURE_STREAM);
+    uint32_t flags = (STM32F4xx_DMA2->LISR >> shift) & STM32F4xx_DMA_FLAG_ALL;
+    size_t half = capture.cfg.length >> 1;
+
+    STM32F4xx_DMA2->LIFCR = flags << shift;
+
+    if(flags & STM32F4xx_DMA_FLAG_TE)
+    {
+        (void) stop_capture();
+        if(capture.cfg.error_callback != NULL)
+        {
+            capture.cfg.error_callback(E_ERR);
+        }
+        return;
+    }
+
+    // the first half is complete on half transfer, the second one on 
+    // transfer complete, both flags can be pending after a long delay
+    for(uint8_t part = 0; part < 2; part++)
+    {
+        if((flags & (part == 0 ? STM32F4xx_DMA_FLAG_HT : STM32F4xx_DMA_FLAG_TC)) == 0)
+        {
+            continue;
+        }
+
+        const uint16_t *samples = &capture.cfg.buffer[part * half];
+        if(capture.cfg.mode == GPIOIF_CAPTURE_RLE)
+        {
+            compress_samples(samples, half);
+            flush_runs();
+        }
+        else if(part == 0)
+        {
+            capture.cfg.half_callback(samples, half);
+        }
+        else
+        {
+            capture.cfg.full_callback(samples, half);
+        }
+    }
+}
+
+static void compress_samples(const uint16_t *samples, size_t count)
+{
+    uint16_t mask = capture.cfg.mask;
+    uint16_t value = capture.run_value;
+    uint16_t length = capture.run_length;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        uint16_t sample = samples[i] & mask;
+
+        if(length != 0 && sample == value && length != 0xFFFF)
+        {
+            length++;
+            continue;
+        }
+
+        // close the open run, the run buffer is passed on when it is full
+        if(length != 0)
+        {
+            capture.cfg.runs[capture.runs_count].value = value;
+            capture.cfg.runs[capture.runs_count].length = length;
+            capture.runs_count++;
+            if(capture.runs_count == capture.cfg.runs_length)
+            {
+                flush_runs();
+            }
+        }
+        value = sample;
+        length = 1;
+    }
+
+    // the open run is continued by the next half
+    capture.run_value = value;
+    capture.run_length = length;
+}
+
+static void flush_runs(void)
+{
+    if(capture.runs_count != 0)
+    {
+        capture.cfg.run_callback(capture.cfg.runs, capture.runs_count);
+        capture.runs_count = 0;
+    }
+}
+
+/**
+ * @brief Stops the capture and returns the flags of the stream which were 
+ *        pending, i.e. halves whose interrupt was not served
+ */
+static uint32_t stop_capture(void)
+{
+    uint32_t shift = STM32F4xx_DMA_FLAG_SHIFT(STM32F4xx_CAPTURE_STREAM);
+
+    STM32F4xx_TIM1->CR1 = 0;
+    STM32F4xx_TIM1->DIER = 0;
+    stm32f4xx_disable_irq(STM32F4xx_DMA2_STREAM1_IRQ);
+    disable_stream(&STM32F4xx_DMA2->STREAM[STM32F4xx_CAPTURE_STREAM]);
+    uint32_t flags = (STM32F4xx_DMA2->LISR >> shift) & STM32F4xx_DMA_FLAG_ALL;
+    STM32F4xx_DMA2->LIFCR = STM32F4xx_DMA_FLAG_ALL << shift;
+    dma_owner = STM32F4xx_GPIO_DMA_IDLE;
+
+    return flags;
+}
+
+static void stop_waveform(void)
+{
+    STM32F4xx_TIM1->CR1 = 0;
+    STM32F4xx_TIM1->DIER = 0;
+    stm32f4xx_disable_irq(STM32F4xx_DMA2_STREAM5_IRQ);
+    disable_stream(&STM32F4xx_DMA2->STREAM[STM32F4xx_WAVEFORM_STREAM]);
+    STM32F4xx_DMA2->HIFCR = STM32F4xx_DMA_FLAG_ALL << STM32F4xx_DMA_FLAG_SHIFT(STM32F4xx_WAVEFORM_STREAM);
+    dma_owner = STM32F4xx_GPIO_DMA_IDLE;
+}
+
+static void disable_stream(STM32F4xx_DMA_Stream_RegDef_t *stream)
+{
+    stream->CR &= ~STM32F4xx_DMA_CR_EN;
+    // a running transfer finishes the current data item first
+    while(stream->CR & STM32F4xx_DMA_CR_EN)
+    {
+    }
+}
+
+static std_return_type_t set_timer_rate(STM32F4xx_TIM_RegDef_t *timer, uint32_t rate)
+{
+    identifier_t clock_id = SysClockIf_get_clock_id(timer_clock);
+    uint32_t timer_frequency = SysClockIf_get_clock_frequency(clock_id);
+
+    if(rate == 0 || rate > timer_frequency)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    // 16 bit prescaler and auto reload
+    uint32_t ticks = timer_frequency / rate;
+    uint32_t prescaler = (ticks - 1) >> 16;
+    if(prescaler > 0xFFFF)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    timer->PSC = prescaler;
+    timer->ARR = (ticks / (prescaler + 1)) - 1;
+    timer->RCR = 0;
+    timer->CNT = 0;
+    // load the prescaler, no DMA request is enabled yet
+    timer->EGR = STM32F4xx_TIM_EGR_UG;
+    timer->SR = 0;
+
+    return E_OK;
+}
+
@@ -5,7 +5,8 @@
  * @brief File containing STM32F4xx I2C API
  *
  * This file implements the generic I2C interface 
- * API for the STM32F4xx series.
+ * API for the STM32F4xx series. Bus ids following the I2C
+ * peripherals are software buses, see stm32f4xx_I2CIf.h.
  */
 
 #include <stdint.h>
@@ -14,6 +15,7 @@
 #include "I2CIf.h"
 #include "SysClockIf.h"
 #include "stm32f4xx_interrupt.h"
+#include "stm32f4xx_I2CIf.h"
 
 typedef struct _stm32f4xx_I2C_config
 { 
@@ -28,6 +30,7 @@ typedef struct _stm32f4xx_I2C_config
     uint8_t *buffer;                                    // buffer where data is stored
     I2CIf_bus_state_t state;                            // current state of the bus
     I2CIf_flags_t flags;                                // I2C flags
+    stm32f4xx_I2C_call_t call;                          // snapshot for the deferred callbacks
 } stm32f4xx_I2C_config_t;
 
 char parent_clock[] = "APB1";
@@ -42,11 +45,18 @@ static void handle_I2C_event_master_transmit(stm32f4xx_I2C_config_t *i2c_bus_cfg
 static void handle_I2C_event_master_receive(stm32f4xx_I2C_config_t *i2c_bus_cfg, STM32F4xx_I2C_RegDef_t* reg);
 static void handle_I2C_event_slave_transmit(stm32f4xx_I2C_config_t *i2c_bus_cfg, STM32F4xx_I2C_RegDef_t* reg);
 static void handle_I2C_event_slave_receive(stm32f4xx_I2C_config_t *i2c_bus_cfg, STM32F4xx_I2C_RegDef_t* reg);
+static void handle_I2C_error(stm32f4xx_I2C_config_t *i2c_bus_cfg, identifier_t i2c_bus_id, STM32F4xx_I2C_RegDef_t* reg);
+static void clear_call(stm32f4xx_I2C_call_t *call);
+static void call_work(void *context);
 
 stm32f4xx_I2C_config_t bus_config[3];
 
 std_return_type_t I2CIf_init(identifier_t i2c_bus_id)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_init(i2c_bus_id);
+    }
 
     std_return_type_t status = E_OK;
 
@@ -120,6 +130,10 @@ std_return_type_t I2CIf_init(identifier_t i2c_bus_id)
 
 std_return_type_t I2CIf_deinit(identifier_t i2c_bus_id)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_deinit(i2c_bus_id);
+    }
 
     std_return_type_t status = E_OK;
 
@@ -172,6 +186,11 @@ std_return_type_t I2CIf_deinit(identifier_t i2c_bus_id)
 
 std_return_type_t I2CIf_config(identifier_t i2c_bus_id, I2CIf_handle_t *bus_cfg)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_config(i2c_bus_id, bus_cfg);
+    }
+
     std_return_type_t status = E_OK;
     STM32F4xx_I2C_RegDef_t *i2c_registers;
     
@@ -224,6 +243,12 @@ std_return_type_t I2CIf_config(identifier_t i2c_bus_id, I2CIf_handle_t *bus_cfg)
     {
         return E_NOT_EXISTING;
     }
+
+    // the EV/ER handlers share the bus state with the critical sections
+    if(bus_cfg->set_priority == TRUE && !STM32F4xx_DRIVER_PRIORITY_VALID(bus_cfg->priority))
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
     
     if(bus_cfg->device_mode & I2CIF_MASTER)
     {
@@ -259,18 +284,18 @@ static void set_interrupts(identifier_t i2c_bus_id, I2CIf_handle_t *bus_cfg, STM
         // enable IRQs for interrupts
         if(i2c_bus_id == 1)
         {
-            stm32f4xx_disable_interrupt(STM32F4xx_I2C1_EV_IRQ);
-            stm32f4xx_disable_interrupt(STM32F4xx_I2C1_ER_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_I2C1_EV_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_I2C1_ER_IRQ);
         }
         else if(i2c_bus_id == 2)
         {
-            stm32f4xx_disable_interrupt(STM32F4xx_I2C2_EV_IRQ);
-            stm32f4xx_disable_interrupt(STM32F4xx_I2C2_ER_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_I2C2_EV_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_I2C2_ER_IRQ);
         }
         else if(i2c_bus_id == 3)
         {
-            stm32f4xx_disable_interrupt(STM32F4xx_I2C3_EV_IRQ);
-            stm32f4xx_disable_interrupt(STM32F4xx_I2C3_ER_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_I2C3_EV_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_I2C3_ER_IRQ);
         }
     }
     else
@@ -278,22 +303,29 @@ static void set_interrupts(identifier_t i2c_bus_id, I2CIf_handle_t *bus_cfg, STM
         i2c_registers->I2C_CR2.ITEVTEN = 1;
         i2c_registers->I2C_CR2.ITBUFEN = 1;
         i2c_registers->I2C_CR2.ITERREN = 1;
-        // enable IRQs for interrupts
-        if(i2c_bus_id == 1)
+
+        STM32F4xx_IRQ_t ev_irq = STM32F4xx_I2C1_EV_IRQ;
+        STM32F4xx_IRQ_t er_irq = STM32F4xx_I2C1_ER_IRQ;
+        if(i2c_bus_id == 2)
         {
-            stm32f4xx_enable_interrupt(STM32F4xx_I2C1_EV_IRQ);
-            stm32f4xx_enable_interrupt(STM32F4xx_I2C1_ER_IRQ);
+            ev_irq = STM32F4xx_I2C2_EV_IRQ;
+            er_irq = STM32F4xx_I2C2_ER_IRQ;
         }
-        else if(i2c_bus_id == 2)
+        else if(i2c_bus_id == 3)
         {
-            stm32f4xx_enable_interrupt(STM32F4xx_I2C2_EV_IRQ);
-            stm32f4xx_enable_interrupt(STM32F4xx_I2C2_ER_IRQ);
+            ev_irq = STM32F4xx_I2C3_EV_IRQ;
+            er_irq = STM32F4xx_I2C3_ER_IRQ;
         }
-        else if(i2c_bus_id == 3)
+
+        // the priority is set before the IRQs can fire
+        if(bus_cfg->set_priority == TRUE)
         {
-            stm32f4xx_enable_interrupt(STM32F4xx_I2C3_EV_IRQ);
-            stm32f4xx_enable_interrupt(STM32F4xx_I2C3_ER_IRQ);
+            stm32f4xx_set_interrupt_priority(ev_irq, bus_cfg->priority);
+            stm32f4xx_set_interrupt_priority(er_irq, bus_cfg->priority);
         }
+        // enable IRQs for interrupts
+        stm32f4xx_enable_irq(ev_irq);
+        stm32f4xx_enable_irq(er_irq);
     }
 }
 
@@ -383,6 +415,11 @@ static std_return_type_t stm32f4xx_I2CIf_config_slave(identifier_t i2c_bus_id, I
 std_return_type_t I2CIf_send(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint16_t address, 
                              uint16_t data_length, uint8_t *data)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_send(i2c_bus_id, flags, address, data_length, data);
+    }
+
 
     if(i2c_bus_id <= 0 || i2c_bus_id > 3)
     {
@@ -400,12 +437,11 @@ std_return_type_t I2CIf_send(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint1
     {
         return E_VALUE_ERR;
     }
-    else
-    {
-        bus_config[i2c_bus_id-1].buffer = data;
-        bus_config[i2c_bus_id-1].buffer_length = data_length;
-    }
-    
+
+    // the event interrupt must not see a partly set up transfer
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    bus_config[i2c_bus_id-1].buffer = data;
+    bus_config[i2c_bus_id-1].buffer_length = data_length;
 
     // check if address is 10 bit address
     if(address & 0xFF80)
@@ -420,6 +456,9 @@ std_return_type_t I2CIf_send(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint1
         bus_config[i2c_bus_id-1].address = address << 1;
     }
 
+    bus_config[i2c_bus_id-1].state = I2CIF_STATE_ARBITRATION;
+    bus_config[i2c_bus_id-1].flags = flags;
+
     if(i2c_bus_id == 1)
     {
         STM32F4XX_I2C1_REG->I2C_CR1.START = 1;
@@ -432,9 +471,7 @@ std_return_type_t I2CIf_send(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint1
     {
         STM32F4XX_I2C3_REG->I2C_CR1.START = 1;
     }
-
-    bus_config[i2c_bus_id-1].state = I2CIF_STATE_ARBITRATION;
-    bus_config[i2c_bus_id-1].flags = flags;
+    stm32f4xx_critical_exit(critical);
     
     return E_OK;
 }
@@ -442,6 +479,11 @@ std_return_type_t I2CIf_send(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint1
 std_return_type_t I2CIf_read(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint16_t address,
                              uint16_t buffer_length, uint8_t *buffer)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_read(i2c_bus_id, flags, address, buffer_length, buffer);
+    }
+
     if(i2c_bus_id <= 0 || i2c_bus_id > 3)
     {
         return E_NOT_EXISTING;
@@ -458,12 +500,11 @@ std_return_type_t I2CIf_read(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint1
     {
         return E_VALUE_ERR;
     }
-    else
-    {
-        bus_config[i2c_bus_id-1].buffer = buffer;
-        bus_config[i2c_bus_id-1].buffer_length = buffer_length;
-    }
 
+    // the event interrupt must not see a partly set up transfer
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    bus_config[i2c_bus_id-1].buffer = buffer;
+    bus_config[i2c_bus_id-1].buffer_length = buffer_length;
     bus_config[i2c_bus_id-1].flags = flags;
     // check if address is 10 bit address
     if(address & 0xFF80)
@@ -478,6 +519,8 @@ std_return_type_t I2CIf_read(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint1
         bus_config[i2c_bus_id-1].address = address << 1 | 1;
     }
 
+    bus_config[i2c_bus_id-1].state = I2CIF_STATE_ARBITRATION;
+
     if(i2c_bus_id == 1)
     {
         STM32F4XX_I2C1_REG->I2C_CR1.START = 1;
@@ -490,22 +533,29 @@ std_return_type_t I2CIf_read(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint1
     {
         STM32F4XX_I2C3_REG->I2C_CR1.START = 1;
     }
-
-    bus_config[i2c_bus_id-1].state = I2CIF_STATE_ARBITRATION;
+    stm32f4xx_critical_exit(critical);
 
     return E_OK;
 }
 
 std_return_type_t I2CIf_stop_transmission(identifier_t i2c_bus_id)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_stop_transmission(i2c_bus_id);
+    }
+
     std_return_type_t status = E_OK;
     
     if( i2c_bus_id < 1 || i2c_bus_id > 3)
     {
-        status = E_NOT_EXISTING;
+        return E_NOT_EXISTING;
     }
-    else if( bus_config[i2c_bus_id-1].state == I2CIF_STATE_MASTER_RECEIVER || 
-             bus_config[i2c_bus_id-1].state == I2CIF_STATE_MASTER_TRANSMITTER)
+
+    // the state is checked and changed without the event interrupt
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    if( bus_config[i2c_bus_id-1].state == I2CIF_STATE_MASTER_RECEIVER || 
+        bus_config[i2c_bus_id-1].state == I2CIF_STATE_MASTER_TRANSMITTER)
     {
         bus_config[i2c_bus_id-1].state = I2CIF_STATE_IDLE;
 
@@ -513,11 +563,11 @@ std_return_type_t I2CIf_stop_transmission(identifier_t i2c_bus_id)
         {
             STM32F4XX_I2C1_REG->I2C_CR1.STOP = 1;
         } 
-        else if(i2c_bus_id == 1)
+        else if(i2c_bus_id == 2)
         {
             STM32F4XX_I2C2_REG->I2C_CR1.STOP = 1;
         }
-        else if(i2c_bus_id == 1)
+        else if(i2c_bus_id == 3)
         {
             STM32F4XX_I2C3_REG->I2C_CR1.STOP = 1;
         }
@@ -526,12 +576,18 @@ std_return_type_t I2CIf_stop_transmission(identifier_t i2c_bus_id)
     {
         status = E_STATE_ERR;
     }
+    stm32f4xx_critical_exit(critical);
 
     return status;
 }
 
 I2CIf_status_t I2CIf_get_status(identifier_t i2c_bus_id)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_get_status(i2c_bus_id);
+    }
+
     I2CIf_status_t status;
     status.raw = 0;
 
@@ -540,13 +596,13 @@ I2CIf_status_t I2CIf_get_status(identifier_t i2c_bus_id)
     {
         registers = STM32F4XX_I2C1_REG;
     } 
-    else if(i2c_bus_id == 1)
+    else if(i2c_bus_id == 2)
     {
-        registers = STM32F4XX_I2C1_REG;
+        registers = STM32F4XX_I2C2_REG;
     }
-    else if(i2c_bus_id == 1)
+    else if(i2c_bus_id == 3)
     {
-        registers = STM32F4XX_I2C1_REG;
+        registers = STM32F4XX_I2C3_REG;
     }
     else
     {
@@ -574,6 +630,11 @@ I2CIf_status_t I2CIf_get_status(identifier_t i2c_bus_id)
 
 I2CIf_bus_state_t I2CIf_get_bus_status(identifier_t i2c_bus_id)
 {
+    if(STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return stm32f4xx_soft_I2CIf_get_bus_status(i2c_bus_id);
+    }
+
     if(i2c_bus_id < 1 || i2c_bus_id > 3)
     {
         return I2CIF_STATE_DISABLED;
@@ -673,7 +734,7 @@ static void handle_I2C_event_master_transmit(stm32f4xx_I2C_config_t *i2c_bus_cfg
 
         if(i2c_bus_cfg->send_callback != NULL)
         {
-            i2c_bus_cfg->send_callback();
+            stm32f4xx_I2CIf_defer_send(&i2c_bus_cfg->call, i2c_bus_cfg->send_callback);
         }
     }
 }
@@ -710,7 +771,7 @@ static void handle_I2C_event_master_receive(stm32f4xx_I2C_config_t *i2c_bus_cfg,
         if( i2c_bus_cfg->buffer_index >= i2c_bus_cfg->buffer_length && 
             i2c_bus_cfg->read_callback != NULL)
         {
-            i2c_bus_cfg->read_callback(index, i2c_bus_cfg->buffer);
+            stm32f4xx_I2CIf_defer_read(&i2c_bus_cfg->call, i2c_bus_cfg->read_callback, index, i2c_bus_cfg->buffer);
         }
 
         if(i2c_bus_cfg->flags & I2CIF_SEND_STOP)
@@ -733,6 +794,86 @@ static void handle_I2C_event_slave_receive(stm32f4xx_I2C_config_t *i2c_bus_cfg,
 
 }
 
+static void handle_I2C_error(stm32f4xx_I2C_config_t *i2c_bus_cfg, identifier_t i2c_bus_id, STM32F4xx_I2C_RegDef_t* reg)
+{
+    I2CIf_status_t status = I2CIf_get_status(i2c_bus_id);
+    // the flags are cleared here, otherwise the interrupt would be taken
+    // again before the deferred callback runs
+    reg->I2C_SR1.raw = (uint16_t) ~STM32F4xx_I2C_SR1_ERRORS;
+
+    if(i2c_bus_cfg->error_callback != NULL)
+    {
+        stm32f4xx_I2CIf_defer_error(&i2c_bus_cfg->call, i2c_bus_cfg->error_callback, status);
+    }
+}
+
+void stm32f4xx_I2CIf_defer_send(stm32f4xx_I2C_call_t *call, void (*callback)())
+{
+    if(stm32f4xx_claim_call(&call->call) == TRUE)
+    {
+        clear_call(call);
+        call->send_callback = callback;
+        stm32f4xx_defer_call(&call->call, call_work);
+    }
+}
+
+void stm32f4xx_I2CIf_defer_read(stm32f4xx_I2C_call_t *call, void (*callback)(uint8_t, uint8_t*),
+                                uint8_t length, uint8_t *buffer)
+{
+    if(stm32f4xx_claim_call(&call->call) == TRUE)
+    {
+        clear_call(call);
+        call->read_callback = callback;
+        call->length = length;
+        call->buffer = buffer;
+        stm32f4xx_defer_call(&call->call, call_work);
+    }
+}
+
+void stm32f4xx_I2CIf_defer_error(stm32f4xx_I2C_call_t *call, void (*callback)(I2CIf_status_t),
+                                 I2CIf_status_t status)
+{
+    if(stm32f4xx_claim_call(&call->call) == TRUE)
+    {
+        clear_call(call);
+        call->error_callback = callback;
+        call->status = status;
+        stm32f4xx_defer_call(&call->call, call_work);
+    }
+}
+
+static void clear_call(stm32f4xx_I2C_call_t *call)
+{
+    call->send_callback = NULL;
+    call->read_callback = NULL;
+    call->error_callback = NULL;
+}
+
+/**
+ * @brief Runs the callback of a snapshot
+ *
+ * The snapshot is copied before the record is released, so the callback
+ * may start the next transfer of the bus.
+ */
+static void call_work(void *context)
+{
+    stm32f4xx_I2C_call_t snapshot = *(stm32f4xx_I2C_call_t *) context;
+    stm32f4xx_release_call(context);
+
+    if(snapshot.send_callback != NULL)
+    {
+        snapshot.send_callback();
+    }
+    else if(snapshot.read_callback != NULL)
+    {
+        snapshot.read_callback(snapshot.length, snapshot.buffer);
+    }
+    else if(snapshot.error_callback != NULL)
+    {
+        snapshot.error_callback(snapshot.status);
+    }
+}
+
 void I2C1_EV_Handler(void)
 {
     handle_I2C_event(&bus_config[0], STM32F4XX_I2C1_REG);
@@ -740,10 +881,7 @@ void I2C1_EV_Handler(void)
 
 void I2C1_ER_Handler(void)
 {
-    if(bus_config[0].error_callback != NULL)
-    {
-        bus_config[0].error_callback(I2CIf_get_status(3));
-    }
+    handle_I2C_error(&bus_config[0], 1, STM32F4XX_I2C1_REG);
 }
 
 void I2C2_EV_Handler(void)
@@ -753,10 +891,7 @@ void I2C2_EV_Handler(void)
 
 void I2C2_ER_Handler(void)
 {
-    if(bus_config[1].error_callback != NULL)
-    {
-        bus_config[1].error_callback(I2CIf_get_status(2));
-    }
+    handle_I2C_error(&bus_config[1], 2, STM32F4XX_I2C2_REG);
 }
 
 void I2C3_EV_Handler(void)
@@ -766,8 +901,5 @@ void I2C3_EV_Handler(void)
 
 void I2C3_ER_Handler(void)
 {
-    if(bus_config[2].error_callback != NULL)
-    {
-        bus_config[2].error_callback(I2CIf_get_status(3));
-    }
+    handle_I2C_error(&bus_config[2], 3, STM32F4XX_I2C3_REG);
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+/**
+ * @file stm32f4xx_I2CIf.h
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx specific extensions of the I2C API
+ *
+ * This file provides the software I2C buses of the STM32F4xx
+ * series. The bus ids 1-3 are the I2C peripherals, the following
+ * ids are software masters on any two open-drain GPIO's, which are
+ * clocked by the TIM4 interrupt. All software buses are served by
+ * the same interrupt, i.e. they transfer in parallel. The pins of
+ * a software bus have to be set with stm32f4xx_I2CIf_set_soft_pins()
+ * before the bus is initialized with I2CIf_init(), afterwards the
+ * bus is used through the generic I2C API in master mode with 7 bit
+ * addresses.
+ */
+
+#ifndef STM32F4XX_I2CIF_H
+#define STM32F4XX_I2CIF_H
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "I2CIf.h"
+#include "stm32f4xx_interrupt.h"
+
+// I2C peripherals, bus ids 1-3
+#define STM32F4xx_I2C_HW_BUSES          3
+
+// software buses, bus ids 4 ...
+#ifndef STM32F4xx_I2C_SOFT_BUSES
+#define STM32F4xx_I2C_SOFT_BUSES        2
+#endif
+
+// interrupt frequency of TIM4, each interrupt is half of a SCL period of
+// the fastest software bus
+#ifndef STM32F4xx_I2C_SOFT_TICK_FREQUENCY
+#define STM32F4xx_I2C_SOFT_TICK_FREQUENCY   200000UL
+#endif
+
+// bus id of a software bus
+#define STM32F4xx_I2C_SOFT_BUS(n)       (STM32F4xx_I2C_HW_BUSES + 1 + (n))
+#define STM32F4xx_I2C_IS_SOFT_BUS(id)   ((id) > STM32F4xx_I2C_HW_BUSES && \
+                                         (id) <= STM32F4xx_I2C_HW_BUSES + STM32F4xx_I2C_SOFT_BUSES)
+
+/**
+ * @brief Sets the pins of a software I2C bus
+ *
+ * The pins are configured as open-drain outputs by I2CIf_init(), pullups
+ * have to be provided externally. Slaves may stretch the clock.
+ *
+ * @param  identifier_t i2c_bus_id  : Software bus, see STM32F4xx_I2C_SOFT_BUS()
+ * @param  GPIOIf_pin_t scl         : Clock pin
+ * @param  GPIOIf_pin_t sda         : Data pin
+ * @return std_return_type_t status : If the bus id is no software bus or a
+ *                                    pin does not exist the function returns
+ *                                    E_NOT_EXISTING. If the pins are equal
+ *                                    the function returns E_CFG_ERR. If the
+ *                                    bus is initialized the function returns
+ *                                    E_STATE_INIT. Else it returns E_OK.
+ */
+std_return_type_t stm32f4xx_I2CIf_set_soft_pins(identifier_t i2c_bus_id, GPIOIf_pin_t scl, GPIOIf_pin_t sda);
+
+// snapshot of a finished transfer, the callback of the peripheral and 
+// the software buses runs with it at the lowest interrupt priority
+typedef struct _stm32f4xx_I2C_call
+{
+    stm32f4xx_deferred_call_t call;                     // first member, the record is the work context
+    void (*send_callback)();
+    void (*read_callback)(uint8_t, uint8_t*);
+    void (*error_callback)(I2CIf_status_t);
+    uint8_t length;                                     // length argument of the read callback
+    uint8_t *buffer;                                    // buffer argument of the read callback
+    I2CIf_status_t status;                              // argument of the error callback
+} stm32f4xx_I2C_call_t;
+
+// queue one callback of a bus from its interrupt, the call is dropped 
+// while the previous call of the bus is still queued
+void stm32f4xx_I2CIf_defer_send(stm32f4xx_I2C_call_t *call, void (*callback)());
+void stm32f4xx_I2CIf_defer_read(stm32f4xx_I2C_call_t *call, void (*callback)(uint8_t, uint8_t*),
+                                uint8_t length, uint8_t *buffer);
+void stm32f4xx_I2CIf_defer_error(stm32f4xx_I2C_call_t *call, void (*callback)(I2CIf_status_t),
+                                 I2CIf_status_t status);
+
+// software bus implementation of the generic API, called by the generic
+// functions for software bus ids
+std_return_type_t stm32f4xx_soft_I2CIf_init(identifier_t i2c_bus_id);
+std_return_type_t stm32f4xx_soft_I2CIf_deinit(identifier_t i2c_bus_id);
+std_return_type_t stm32f4xx_soft_I2CIf_config(identifier_t i2c_bus_id, I2CIf_handle_t *bus_cfg);
+std_return_type_t stm32f4xx_soft_I2CIf_send(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint16_t address,
+                                            uint16_t data_length, uint8_t *data);
+std_return_type_t stm32f4xx_soft_I2CIf_read(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint16_t address,
+                                            uint16_t buffer_length, uint8_t *buffer);
+std_return_type_t stm32f4xx_soft_I2CIf_stop_transmission(identifier_t i2c_bus_id);
+I2CIf_status_t stm32f4xx_soft_I2CIf_get_status(identifier_t i2c_bus_id);
+I2CIf_bus_state_t stm32f4xx_soft_I2CIf_get_bus_status(identifier_t i2c_bus_id);
+
+#endif
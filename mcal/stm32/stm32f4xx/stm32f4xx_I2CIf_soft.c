@@ -0,0 +1,716 @@
+/**
+ * @file stm32f4xx_I2CIf_soft.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx software I2C master
+ *
+ * This file implements the software I2C buses of the STM32F4xx
+ * series. TIM4 interrupts every half SCL period, each interrupt
+ * advances the transfer of every active bus by one step. SCL and
+ * SDA are open-drain outputs which are released or pulled low with
+ * BSRR. SDA is changed while SCL is low and sampled right before
+ * SCL is pulled low again, a slave holding SCL low stretches the
+ * step.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "I2CIf.h"
+#include "SysClockIf.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_interrupt.h"
+#include "stm32f4xx_I2CIf.h"
+
+// clock stretching longer than 25 ms aborts the transfer
+#define STM32F4xx_I2C_SOFT_STRETCH_TIMEOUT  (STM32F4xx_I2C_SOFT_TICK_FREQUENCY / 40)
+
+#define SOFT_BUS(id)            (&soft_buses[(id) - STM32F4xx_I2C_SOFT_BUS(0)])
+
+#define SCL_RELEASE(bus)        ((bus)->scl_port->BSRR = (bus)->scl_mask)
+#define SCL_LOW(bus)            ((bus)->scl_port->BSRR = (uint32_t) (bus)->scl_mask << 16)
+#define SCL_READ(bus)           (((bus)->scl_port->IDR & (bus)->scl_mask) != 0)
+#define SDA_RELEASE(bus)        ((bus)->sda_port->BSRR = (bus)->sda_mask)
+#define SDA_LOW(bus)            ((bus)->sda_port->BSRR = (uint32_t) (bus)->sda_mask << 16)
+#define SDA_WRITE(bus, level)   ((bus)->sda_port->BSRR = (level) ? (bus)->sda_mask : (uint32_t) (bus)->sda_mask << 16)
+#define SDA_READ(bus)           (((bus)->sda_port->IDR & (bus)->sda_mask) != 0)
+
+typedef enum _stm32f4xx_soft_I2C_step
+{
+    STEP_IDLE = 0,
+    STEP_RESTART_SDA_HIGH,      // SCL low, release SDA for a repeated start
+    STEP_RESTART_SCL_HIGH,      // release SCL for a repeated start
+    STEP_START_SDA_LOW,         // SCL high, start condition
+    STEP_START_SCL_LOW,         // pull SCL low, put the first address bit
+    STEP_BIT_HIGH,              // release SCL, the bit is valid
+    STEP_BIT_LOW,               // sample SDA, pull SCL low, put the next bit
+    STEP_STOP_SCL_HIGH,         // SDA low, release SCL
+    STEP_STOP_SDA_HIGH,         // SCL high, stop condition
+} stm32f4xx_soft_I2C_step_t;
+
+typedef struct _stm32f4xx_soft_I2C_bus
+{
+    void (*send_callback)();                            // callback function when the write cycle has finished
+    void (*read_callback)(uint8_t, uint8_t*);           // callback to return buffer and read length when read is finished
+    void (*error_callback)(I2CIf_status_t);             // callback if a error was detected
+    STM32F4xx_GPIO_RegDef_t *scl_port;
+    STM32F4xx_GPIO_RegDef_t *sda_port;
+    GPIOIf_pin_t scl;
+    GPIOIf_pin_t sda;
+    uint16_t scl_mask;
+    uint16_t sda_mask;
+    uint8_t *buffer;                                    // buffer where data is stored
+    uint16_t buffer_index;                              // current index of the buffer
+    uint16_t buffer_length;                             // total buffer length
+    uint16_t divider;                                   // timer ticks per half SCL period
+    uint16_t countdown;                                 // timer ticks until the next step
+    uint32_t stretch;                                   // timer ticks SCL is held low by a slave
+    uint8_t address;                                    // address byte including the read bit
+    uint8_t byte;                                       // byte being shifted
+    uint8_t bit;                                        // bit of byte, 8 is the acknowledge
+    boolean address_phase;                              // TRUE while the address byte is shifted
+    boolean pins_set;
+    volatile stm32f4xx_soft_I2C_step_t step;            // next step, STEP_IDLE if no transfer runs
+    I2CIf_flags_t flags;                                // I2C flags
+    I2CIf_status_t status;                              // result of the last transfer
+    volatile I2CIf_bus_state_t state;                   // current state of the bus
+    stm32f4xx_I2C_call_t call;                          // snapshot for the deferred callbacks
+} stm32f4xx_soft_I2C_bus_t;
+
+static char timer_clock[] = "APB1 Timer";
+
+static stm32f4xx_soft_I2C_bus_t soft_buses[STM32F4xx_I2C_SOFT_BUSES] = {};
+static uint8_t buses_initialized = 0;
+
+static std_return_type_t start_transfer(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint8_t address,
+                                        uint16_t length, uint8_t *buffer);
+static std_return_type_t setup_transfer(stm32f4xx_soft_I2C_bus_t *bus, I2CIf_flags_t flags, uint8_t address,
+                                        uint16_t length, uint8_t *buffer);
+static void step_bus(stm32f4xx_soft_I2C_bus_t *bus);
+static void clock_bit(stm32f4xx_soft_I2C_bus_t *bus);
+static void load_byte(stm32f4xx_soft_I2C_bus_t *bus, uint8_t byte);
+static boolean scl_stretched(stm32f4xx_soft_I2C_bus_t *bus);
+static void finish_transfer(stm32f4xx_soft_I2C_bus_t *bus, I2CIf_bus_state_t state);
+static boolean transfer_failed(stm32f4xx_soft_I2C_bus_t *bus);
+static void start_timer(void);
+
+std_return_type_t stm32f4xx_I2CIf_set_soft_pins(identifier_t i2c_bus_id, GPIOIf_pin_t scl, GPIOIf_pin_t sda)
+{
+    if(!STM32F4xx_I2C_IS_SOFT_BUS(i2c_bus_id))
+    {
+        return E_NOT_EXISTING;
+    }
+
+    stm32f4xx_soft_I2C_bus_t *bus = SOFT_BUS(i2c_bus_id);
+    if(bus->state != I2CIF_STATE_DISABLED)
+    {
+        return E_STATE_INIT;
+    }
+    // the ports are written before GPIOIf_config_pin() can check the pins
+    if(stm32f4xx_GPIO_pin_exists(scl) == FALSE || stm32f4xx_GPIO_pin_exists(sda) == FALSE)
+    {
+        return E_NOT_EXISTING;
+    }
+    if(scl == sda)
+    {
+        return E_CFG_ERR;
+    }
+
+    bus->scl = scl;
+    bus->sda = sda;
+    bus->pins_set = TRUE;
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_soft_I2CIf_init(identifier_t i2c_bus_id)
+{
+    stm32f4xx_soft_I2C_bus_t *bus = SOFT_BUS(i2c_bus_id);
+
+    if(bus->state != I2CIF_STATE_DISABLED)
+    {
+        return E_STATE_INIT;
+    }
+    if(bus->pins_set == FALSE)
+    {
+        return E_CFG_ERR;
+    }
+
+    identifier_t clock_id = SysClockIf_get_clock_id(timer_clock);
+    uint32_t timer_frequency = SysClockIf_get_clock_frequency(clock_id);
+    if(timer_frequency < STM32F4xx_I2C_SOFT_TICK_FREQUENCY ||
+       (timer_frequency / STM32F4xx_I2C_SOFT_TICK_FREQUENCY) > 0x10000)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    GPIOIf_pin_config_t cfg = {};
+    cfg.pin_mode = GPIOIf_OUTPUT;
+    cfg.output_mode = GPIOIF_OUTPUT_OPEN_DRAIN;
+    cfg.pullup_mode = GPIOIf_NO_PULLUP;
+    cfg.trigger = GPIOIf_NO_TRIGGER;
+
+    // release the lines before the pins become outputs, the pins exist,
+    // see stm32f4xx_I2CIf_set_soft_pins()
+    STM32F4xx_GPIO_PORT_REG(bus->scl)->BSRR = STM32F4xx_GPIO_PIN_MASK(bus->scl);
+    STM32F4xx_GPIO_PORT_REG(bus->sda)->BSRR = STM32F4xx_GPIO_PIN_MASK(bus->sda);
+
+    cfg.pin = bus->scl;
+    std_return_type_t status = GPIOIf_config_pin(&cfg);
+    if(status != E_OK)
+    {
+        return status;
+    }
+    cfg.pin = bus->sda;
+    status = GPIOIf_config_pin(&cfg);
+    if(status != E_OK)
+    {
+        return status;
+    }
+
+    bus->scl_port = STM32F4xx_GPIO_PORT_REG(bus->scl);
+    bus->scl_mask = STM32F4xx_GPIO_PIN_MASK(bus->scl);
+    bus->sda_port = STM32F4xx_GPIO_PORT_REG(bus->sda);
+    bus->sda_mask = STM32F4xx_GPIO_PIN_MASK(bus->sda);
+    bus->divider = 1;
+    bus->step = STEP_IDLE;
+    bus->status.raw = 0;
+
+    // the timer runs while a software bus is initialized, its interrupt is
+    // enabled while a transfer runs
+    if(buses_initialized == 0)
+    {
+        STM32F4xx_TIM4_PCLK_EN();
+
+        STM32F4xx_TIM4->CR1 = 0;
+        STM32F4xx_TIM4->DIER = 0;
+        // one update per tick
+        STM32F4xx_TIM4->PSC = 0;
+        STM32F4xx_TIM4->ARR = (timer_frequency / STM32F4xx_I2C_SOFT_TICK_FREQUENCY) - 1;
+        STM32F4xx_TIM4->EGR = STM32F4xx_TIM_EGR_UG;
+        STM32F4xx_TIM4->SR = 0;
+        STM32F4xx_TIM4->CR1 = STM32F4xx_TIM_CR1_URS | STM32F4xx_TIM_CR1_CEN;
+
+        stm32f4xx_enable_irq(STM32F4xx_TIM4_IRQ);
+    }
+    buses_initialized++;
+
+    if(SCL_READ(bus) == 0 || SDA_READ(bus) == 0)
+    {
+        bus->state = I2CIF_STATE_BUSY;
+    }
+    else
+    {
+        bus->state = I2CIF_STATE_IDLE;
+    }
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_soft_I2CIf_deinit(identifier_t i2c_bus_id)
+{
+    stm32f4xx_soft_I2C_bus_t *bus = SOFT_BUS(i2c_bus_id);
+
+    if(bus->state != I2CIF_STATE_IDLE && bus->state != I2CIF_STATE_BUSY)
+    {
+        return E_STATE_ERR;
+    }
+
+    SCL_RELEASE(bus);
+    SDA_RELEASE(bus);
+    bus->state = I2CIF_STATE_DISABLED;
+
+    buses_initialized--;
+    if(buses_initialized == 0)
+    {
+        STM32F4xx_TIM4->DIER = 0;
+        STM32F4xx_TIM4->CR1 = 0;
+        stm32f4xx_disable_irq(STM32F4xx_TIM4_IRQ);
+        STM32F4xx_TIM4_PCLK_DI();
+    }
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_soft_I2CIf_config(identifier_t i2c_bus_id, I2CIf_handle_t *bus_cfg)
+{
+    stm32f4xx_soft_I2C_bus_t *bus = SOFT_BUS(i2c_bus_id);
+
+    if(bus->state == I2CIF_STATE_DISABLED)
+    {
+        return E_STATE_NOINIT;
+    }
+    else if(bus->state != I2CIF_STATE_IDLE && bus->state != I2CIF_STATE_BUSY)
+    {
+        return E_STATE_ERR;
+    }
+    if(bus_cfg == NULL || bus_cfg->master_cfg == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+    // software buses are masters with 7 bit addresses only
+    if(bus_cfg->device_mode != I2CIF_MASTER || bus_cfg->addr_mode == I2CIF_ADDRESS_10BIT)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    I2CIf_master_config *master_cfg = bus_cfg->master_cfg;
+    uint32_t scl_frequency = master_cfg->scl_frequency;
+
+    if(master_cfg->speed == I2CIF_MODE_SM)
+    {
+        if(scl_frequency > 100000)
+        {
+            return E_VALUE_OUT_OF_RANGE;
+        }
+    }
+    else if(master_cfg->speed == I2CIF_MODE_FM)
+    {
+        if(scl_frequency > 400000)
+        {
+            return E_VALUE_OUT_OF_RANGE;
+        }
+    }
+    else
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    // one tick is the shortest half period, the clock is rounded down
+    if(scl_frequency == 0 || 2 * scl_frequency > STM32F4xx_I2C_SOFT_TICK_FREQUENCY)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+    uint32_t divider = (STM32F4xx_I2C_SOFT_TICK_FREQUENCY + 2 * scl_frequency - 1) / (2 * scl_frequency);
+    if(divider > 0xFFFF)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+    // the TIM4 handler shares the bus state with the critical sections
+    if(bus_cfg->set_priority == TRUE && !STM32F4xx_DRIVER_PRIORITY_VALID(bus_cfg->priority))
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    // all software buses share the TIM4 interrupt
+    if(bus_cfg->set_priority == TRUE)
+    {
+        stm32f4xx_set_interrupt_priority(STM32F4xx_TIM4_IRQ, bus_cfg->priority);
+    }
+
+    bus->send_callback = master_cfg->send_callback;
+    bus->read_callback = master_cfg->read_callback;
+    bus->error_callback = master_cfg->error_callback;
+    bus->divider = (uint16_t) divider;
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_soft_I2CIf_send(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint16_t address,
+                                            uint16_t data_length, uint8_t *data)
+{
+    stm32f4xx_soft_I2C_bus_t *bus = SOFT_BUS(i2c_bus_id);
+
+    // a held bus is released with a stop condition only
+    if(data == NULL && (flags & I2CIF_SEND_STOP) && bus->step == STEP_IDLE &&
+       (bus->state == I2CIF_STATE_MASTER_TRANSMITTER || bus->state == I2CIF_STATE_MASTER_RECEIVER))
+    {
+        return stm32f4xx_soft_I2CIf_stop_transmission(i2c_bus_id);
+    }
+    if(address & 0xFF80)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    return start_transfer(i2c_bus_id, flags, (uint8_t) (address << 1), data_length, data);
+}
+
+std_return_type_t stm32f4xx_soft_I2CIf_read(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint16_t address,
+                                            uint16_t buffer_length, uint8_t *buffer)
+{
+    if(address & 0xFF80)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    return start_transfer(i2c_bus_id, flags, (uint8_t) (address << 1 | 1), buffer_length, buffer);
+}
+
+std_return_type_t stm32f4xx_soft_I2CIf_stop_transmission(identifier_t i2c_bus_id)
+{
+    stm32f4xx_soft_I2C_bus_t *bus = SOFT_BUS(i2c_bus_id);
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+
+    if(bus->step != STEP_IDLE ||
+       (bus->state != I2CIF_STATE_MASTER_TRANSMITTER && bus->state != I2CIF_STATE_MASTER_RECEIVER))
+    {
+        stm32f4xx_critical_exit(critical);
+        return E_STATE_ERR;
+    }
+
+    // SCL is low while the bus is held, the callback is suppressed
+    bus->flags = 0;
+    bus->buffer_length = 0;
+    bus->status.raw = 0;
+    SDA_LOW(bus);
+    bus->countdown = bus->divider;
+    bus->step = STEP_STOP_SCL_HIGH;
+    start_timer();
+    stm32f4xx_critical_exit(critical);
+
+    return E_OK;
+}
+
+I2CIf_status_t stm32f4xx_soft_I2CIf_get_status(identifier_t i2c_bus_id)
+{
+    return SOFT_BUS(i2c_bus_id)->status;
+}
+
+I2CIf_bus_state_t stm32f4xx_soft_I2CIf_get_bus_status(identifier_t i2c_bus_id)
+{
+    stm32f4xx_soft_I2C_bus_t *bus = SOFT_BUS(i2c_bus_id);
+
+    // a bus which was busy at the initialization becomes idle when released
+    if(bus->state == I2CIF_STATE_BUSY && SCL_READ(bus) && SDA_READ(bus))
+    {
+        bus->state = I2CIF_STATE_IDLE;
+    }
+
+    return bus->state;
+}
+
+void TIM4_Handler(void)
+{
+    boolean active = FALSE;
+
+    // status flags are cleared by writing 0
+    STM32F4xx_TIM4->SR = (uint32_t) ~STM32F4xx_TIM_SR_UIF;
+
+    for(uint8_t i = 0; i < STM32F4xx_I2C_SOFT_BUSES; i++)
+    {
+        stm32f4xx_soft_I2C_bus_t *bus = &soft_buses[i];
+
+        if(bus->step == STEP_IDLE)
+        {
+            continue;
+        }
+        if(--bus->countdown == 0)
+        {
+            bus->countdown = bus->divider;
+            step_bus(bus);
+        }
+        // a transfer started by an interrupt of higher priority keeps the
+        // timer running as well
+        if(bus->step != STEP_IDLE)
+        {
+            active = TRUE;
+        }
+    }
+
+    if(active == FALSE)
+    {
+        STM32F4xx_TIM4->DIER = 0;
+    }
+}
+
+static std_return_type_t start_transfer(identifier_t i2c_bus_id, I2CIf_flags_t flags, uint8_t address,
+                                        uint16_t length, uint8_t *buffer)
+{
+    if(buffer == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+    else if(length == 0)
+    {
+        return E_VALUE_ERR;
+    }
+
+    // the state is checked and changed without the timer interrupt
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+    std_return_type_t status = setup_transfer(SOFT_BUS(i2c_bus_id), flags, address, length, buffer);
+    stm32f4xx_critical_exit(critical);
+
+    return status;
+}
+
+static std_return_type_t setup_transfer(stm32f4xx_soft_I2C_bus_t *bus, I2CIf_flags_t flags, uint8_t address,
+                                        uint16_t length, uint8_t *buffer)
+{
+    boolean held = (bus->state == I2CIF_STATE_MASTER_TRANSMITTER || bus->state == I2CIF_STATE_MASTER_RECEIVER);
+
+    // a transfer starts on an idle bus or continues a held one
+    if(bus->step != STEP_IDLE || (bus->state != I2CIF_STATE_IDLE && held == FALSE))
+    {
+        return E_STATE_ERR;
+    }
+
+    boolean start = (held == FALSE || (flags & I2CIF_SEND_START));
+    // without start condition only the writing of a held transmitter
+    // continues
+    if(start == FALSE && (bus->state != I2CIF_STATE_MASTER_TRANSMITTER || (address & 0x01)))
+    {
+        return E_STATE_ERR;
+    }
+    if(held == FALSE && (SCL_READ(bus) == 0 || SDA_READ(bus) == 0))
+    {
+        return E_STATE_ERR;
+    }
+
+    bus->buffer = buffer;
+    bus->buffer_length = length;
+    bus->buffer_index = 0;
+    bus->flags = flags;
+    bus->address = address;
+    bus->status.raw = 0;
+    bus->stretch = 0;
+    // the interrupt serves the bus as soon as step is set
+    bus->countdown = bus->divider;
+
+    if(start == FALSE)
+    {
+        bus->address_phase = FALSE;
+        load_byte(bus, bus->buffer[bus->buffer_index++]);
+        bus->step = STEP_BIT_HIGH;
+    }
+    else
+    {
+        bus->address_phase = TRUE;
+        bus->step = held ? STEP_RESTART_SDA_HIGH : STEP_START_SDA_LOW;
+        bus->state = I2CIF_STATE_ARBITRATION;
+    }
+    start_timer();
+
+    return E_OK;
+}
+
+static void start_timer(void)
+{
+    STM32F4xx_TIM4->DIER = STM32F4xx_TIM_DIER_UIE;
+}
+
+static void step_bus(stm32f4xx_soft_I2C_bus_t *bus)
+{
+    switch(bus->step)
+    {
+    case STEP_RESTART_SDA_HIGH:
+        SDA_RELEASE(bus);
+        bus->step = STEP_RESTART_SCL_HIGH;
+        break;
+    case STEP_RESTART_SCL_HIGH:
+        SCL_RELEASE(bus);
+        bus->step = STEP_START_SDA_LOW;
+        break;
+    case STEP_START_SDA_LOW:
+        if(scl_stretched(bus) == TRUE)
+        {
+            break;
+        }
+        SDA_LOW(bus);
+        bus->step = STEP_START_SCL_LOW;
+        break;
+    case STEP_START_SCL_LOW:
+        SCL_LOW(bus);
+        bus->state = (bus->address & 0x01) ? I2CIF_STATE_MASTER_RECEIVER : I2CIF_STATE_MASTER_TRANSMITTER;
+        bus->status.start_bit_sent = 1;
+        load_byte(bus, bus->address);
+        bus->step = STEP_BIT_HIGH;
+        break;
+    case STEP_BIT_HIGH:
+        SCL_RELEASE(bus);
+        bus->step = STEP_BIT_LOW;
+        break;
+    case STEP_BIT_LOW:
+        if(scl_stretched(bus) == TRUE)
+        {
+            break;
+        }
+        clock_bit(bus);
+        break;
+    case STEP_STOP_SCL_HIGH:
+        SCL_RELEASE(bus);
+        bus->step = STEP_STOP_SDA_HIGH;
+        break;
+    case STEP_STOP_SDA_HIGH:
+        if(scl_stretched(bus) == TRUE)
+        {
+            break;
+        }
+        SDA_RELEASE(bus);
+        finish_transfer(bus, I2CIF_STATE_IDLE);
+        break;
+    default:
+        bus->step = STEP_IDLE;
+        break;
+    }
+}
+
+static void clock_bit(stm32f4xx_soft_I2C_bus_t *bus)
+{
+    boolean transmit = (bus->address_phase == TRUE || (bus->address & 0x01) == 0);
+    uint8_t sda = SDA_READ(bus);
+
+    if(bus->bit < 8)
+    {
+        if(transmit == FALSE)
+        {
+            bus->byte = (uint8_t) (bus->byte << 1) | sda;
+        }
+        else if((bus->byte & 0x80) && sda == 0)
+        {
+            // another master pulls SDA low, the bus is left to it
+            bus->status.arbitration_lost = 1;
+            finish_transfer(bus, I2CIF_STATE_IDLE);
+            return;
+        }
+        else
+        {
+            bus->byte <<= 1;
+        }
+    }
+    else if(transmit == TRUE && sda != 0)
+    {
+        // not acknowledged, the transfer ends with a stop condition
+        bus->status.acknowledge_failure = 1;
+        SCL_LOW(bus);
+        SDA_LOW(bus);
+        bus->step = STEP_STOP_SCL_HIGH;
+        return;
+    }
+
+    SCL_LOW(bus);
+    bus->bit++;
+
+    if(bus->bit < 8)
+    {
+        SDA_WRITE(bus, transmit == FALSE || (bus->byte & 0x80));
+        bus->step = STEP_BIT_HIGH;
+        return;
+    }
+    if(bus->bit == 8)
+    {
+        if(transmit == TRUE)
+        {
+            SDA_RELEASE(bus);
+        }
+        else
+        {
+            // the last byte is not acknowledged
+            bus->buffer[bus->buffer_index++] = bus->byte;
+            SDA_WRITE(bus, bus->buffer_index >= bus->buffer_length);
+        }
+        bus->step = STEP_BIT_HIGH;
+        return;
+    }
+
+    // the byte including its acknowledge is complete
+    if(bus->address_phase == TRUE)
+    {
+        bus->address_phase = FALSE;
+        bus->status.address_sent_matched = 1;
+    }
+    if(bus->buffer_index < bus->buffer_length)
+    {
+        load_byte(bus, (bus->address & 0x01) ? 0xFF : bus->buffer[bus->buffer_index++]);
+        bus->step = STEP_BIT_HIGH;
+    }
+    else if(bus->flags & I2CIF_SEND_STOP)
+    {
+        SDA_LOW(bus);
+        bus->step = STEP_STOP_SCL_HIGH;
+    }
+    else
+    {
+        // the bus is held with SCL low for a following transfer
+        finish_transfer(bus, bus->state);
+    }
+}
+
+static void load_byte(stm32f4xx_soft_I2C_bus_t *bus, uint8_t byte)
+{
+    // a received byte is shifted in with SDA released
+    bus->byte = byte;
+    bus->bit = 0;
+    SDA_WRITE(bus, byte & 0x80);
+}
+
+/**
+ * @brief Checks if a slave holds SCL low
+ *
+ * A held SCL is polled every timer tick. Once the slave releases it, the
+ * step waits a full half period again, so SCL stays high for at least
+ * half a period before SDA is sampled or SCL is pulled low.
+ */
+static boolean scl_stretched(stm32f4xx_soft_I2C_bus_t *bus)
+{
+    if(SCL_READ(bus) != 0)
+    {
+        if(bus->stretch == 0)
+        {
+            return FALSE;
+        }
+        // the high half period starts when the slave releases SCL
+        bus->stretch = 0;
+        bus->countdown = bus->divider;
+        return TRUE;
+    }
+
+    bus->stretch++;
+    bus->countdown = 1;
+    if(bus->stretch >= STM32F4xx_I2C_SOFT_STRETCH_TIMEOUT)
+    {
+        bus->status.timeout = 1;
+        SDA_RELEASE(bus);
+        SCL_RELEASE(bus);
+        finish_transfer(bus, I2CIF_STATE_IDLE);
+    }
+
+    return TRUE;
+}
+
+static void finish_transfer(stm32f4xx_soft_I2C_bus_t *bus, I2CIf_bus_state_t state)
+{
+    if(transfer_failed(bus) == TRUE)
+    {
+        SDA_RELEASE(bus);
+        SCL_RELEASE(bus);
+    }
+
+    bus->step = STEP_IDLE;
+    bus->state = state;
+
+    // a stop condition sent by stm32f4xx_soft_I2CIf_stop_transmission()
+    // has no callback
+    if(transfer_failed(bus) == TRUE)
+    {
+        if(bus->error_callback != NULL)
+        {
+            stm32f4xx_I2CIf_defer_error(&bus->call, bus->error_callback, bus->status);
+        }
+    }
+    else if(bus->buffer_length == 0)
+    {
+        return;
+    }
+    else if(bus->address & 0x01)
+    {
+        bus->status.receive_finished = 1;
+        if(bus->read_callback != NULL)
+        {
+            stm32f4xx_I2CIf_defer_read(&bus->call, bus->read_callback, (uint8_t) bus->buffer_length, bus->buffer);
+        }
+    }
+    else
+    {
+        bus->status.transmit_finished = 1;
+        if(bus->send_callback != NULL)
+        {
+            stm32f4xx_I2CIf_defer_send(&bus->call, bus->send_callback);
+        }
+    }
+}
+
+static boolean transfer_failed(stm32f4xx_soft_I2C_bus_t *bus)
+{
+    return (bus->status.arbitration_lost || bus->status.acknowledge_failure || bus->status.timeout) ? TRUE : FALSE;
+}
@@ -0,0 +1,613 @@
+/**
+ * @file stm32f4xx_OneWireIf.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx implementation of the 1-Wire master API
+ *
+ * This file implements the generic 1-Wire API for the STM32F4xx
+ * series. TIM3 counts microseconds, its compare channel 1 marks
+ * the edges and the sample point of each slot. The interrupt
+ * drives and samples the pin and selects the next slot of the
+ * transaction, the core is free in between. All compare values are
+ * taken from the start of the slot, a late interrupt which breaks the
+ * timing of a slot aborts the transaction with E_ERR.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "OneWireIf.h"
+#include "SysClockIf.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_interrupt.h"
+#include "stm32f4xx_GPIOIf.h"
+
+// the timer counts microseconds
+#define STM32F4xx_ONEWIRE_TICK_FREQUENCY    1000000UL
+
+// delay from the start of a transaction to the first slot
+#define STM32F4xx_ONEWIRE_START_DELAY       2
+
+typedef enum _stm32f4xx_onewire_slot
+{
+    SLOT_RESET      = 0,
+    SLOT_WRITE_0    = 1,
+    SLOT_WRITE_1    = 2,
+    SLOT_READ       = 3,
+    SLOT_NONE       = 4,
+} stm32f4xx_onewire_slot_t;
+
+// actions at the compare events of a slot
+typedef enum _stm32f4xx_onewire_phase
+{
+    PHASE_START,                                    // pull the line low
+    PHASE_RELEASE,                                  // release the line
+    PHASE_SAMPLE,                                   // read the line
+    PHASE_END,                                      // recovery time is over
+} stm32f4xx_onewire_phase_t;
+
+// position of a transaction
+typedef enum _stm32f4xx_onewire_step
+{
+    STEP_RESET,
+    STEP_WRITE,
+    STEP_READ,
+    STEP_SEARCH_ID,                                 // first read of a ROM bit
+    STEP_SEARCH_COMPLEMENT,                         // second read, complement of the ROM bit
+    STEP_SEARCH_DIRECTION,                          // write of the selected ROM bit
+} stm32f4xx_onewire_step_t;
+
+typedef struct _stm32f4xx_onewire_timing
+{
+    uint16_t low;                                   // low time from the start of the slot
+    uint16_t sample;                                // sample point after the release, 0 for no sample
+    uint16_t end;                                   // remaining time of the slot after release or sample
+    uint16_t max_low;                               // latest release from the start of the slot
+    uint16_t max_sample;                            // latest sample point from the start of the slot
+} stm32f4xx_onewire_timing_t;
+
+// standard speed timings in microseconds, the limits keep a late release
+// from being seen as presence pulse or 0 bit, or a late sample from 
+// missing the presence pulse or the 0 bit of a device
+static const stm32f4xx_onewire_timing_t slot_timings[4] =
+{
+    [SLOT_RESET]    = { 480, 70, 410, 490, 555 },
+    [SLOT_WRITE_0]  = {  60,  0,  10, 120,   0 },
+    [SLOT_WRITE_1]  = {   6,  0,  64,  15,   0 },
+    [SLOT_READ]     = {   5,  5,  60,   8,  15 },
+};
+
+static const uint8_t search_command = ONEWIREIF_CMD_SEARCH_ROM;
+
+static char timer_clock[] = "APB1 Timer";
+
+static boolean initialized = FALSE;
+static volatile boolean busy = FALSE;
+static STM32F4xx_GPIO_RegDef_t *port = NULL;
+static uint16_t mask = 0;
+
+// state of the running transaction, only used by the interrupt while busy
+static stm32f4xx_onewire_slot_t slot = SLOT_NONE;
+static stm32f4xx_onewire_phase_t phase = PHASE_START;
+static stm32f4xx_onewire_step_t step = STEP_RESET;
+static uint8_t sample = 0;
+static uint16_t slot_start = 0;
+static OneWireIf_callback_t callback = NULL;
+static const uint8_t *tx = NULL;
+static size_t tx_bits = 0;
+static uint8_t *rx = NULL;
+static size_t rx_bits = 0;
+static size_t bit = 0;
+
+// state of the ROM search
+static boolean searching = FALSE;
+static uint64_t *roms = NULL;
+static size_t roms_length = 0;
+static size_t *roms_found = NULL;
+static uint64_t rom = 0;
+static uint8_t id_bit = 0;
+static uint8_t last_discrepancy = 0;
+static uint8_t last_zero = 0;
+
+// snapshot of the finished transaction for the deferred callback
+typedef struct _stm32f4xx_onewire_call
+{
+    stm32f4xx_deferred_call_t call;                 // first member, the record is the work context
+    OneWireIf_callback_t callback;
+    std_return_type_t status;
+} stm32f4xx_onewire_call_t;
+
+static stm32f4xx_onewire_call_t finished_call = {};
+
+static boolean claim_bus(void);
+static void schedule(uint16_t offset);
+static void start_transaction(void);
+static void finish_transaction(std_return_type_t status);
+static void callback_work(void *context);
+static stm32f4xx_onewire_slot_t next_slot(void);
+static stm32f4xx_onewire_slot_t next_data_slot(void);
+static stm32f4xx_onewire_slot_t next_search_slot(void);
+
+std_return_type_t OneWireIf_init(const OneWireIf_config_t *onewire_cfg)
+{
+    if(onewire_cfg == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+    if(initialized == TRUE)
+    {
+        return E_STATE_INIT;
+    }
+    if(onewire_cfg->set_priority == TRUE && onewire_cfg->priority > STM32F4xx_NVIC_MAX_PRIORITY)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+    // the port is written before GPIOIf_config_pin() checks the pin
+    if(stm32f4xx_GPIO_pin_exists(onewire_cfg->pin) == FALSE)
+    {
+        return E_NOT_EXISTING;
+    }
+
+    identifier_t clock_id = SysClockIf_get_clock_id(timer_clock);
+    uint32_t timer_frequency = SysClockIf_get_clock_frequency(clock_id);
+    if(timer_frequency < STM32F4xx_ONEWIRE_TICK_FREQUENCY ||
+       (timer_frequency / STM32F4xx_ONEWIRE_TICK_FREQUENCY) > 0x10000)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    GPIOIf_pin_t pin = onewire_cfg->pin;
+    GPIOIf_pin_config_t cfg = {};
+    cfg.pin = pin;
+    cfg.pin_mode = GPIOIf_OUTPUT;
+    cfg.output_mode = GPIOIF_OUTPUT_OPEN_DRAIN;
+    cfg.pullup_mode = GPIOIf_NO_PULLUP;
+    cfg.trigger = GPIOIf_NO_TRIGGER;
+
+    // release the line before the pin becomes an output
+    STM32F4xx_GPIO_PORT_REG(pin)->BSRR = STM32F4xx_GPIO_PIN_MASK(pin);
+    std_return_type_t status = GPIOIf_config_pin(&cfg);
+    if(status != E_OK)
+    {
+        return status;
+    }
+
+    port = STM32F4xx_GPIO_PORT_REG(pin);
+    mask = STM32F4xx_GPIO_PIN_MASK(pin);
+    busy = FALSE;
+
+    STM32F4xx_TIM3_PCLK_EN();
+
+    STM32F4xx_TIM3->CR1 = 0;
+    STM32F4xx_TIM3->DIER = 0;
+    STM32F4xx_TIM3->PSC = (timer_frequency / STM32F4xx_ONEWIRE_TICK_FREQUENCY) - 1;
+    STM32F4xx_TIM3->ARR = 0xFFFF;
+    STM32F4xx_TIM3->EGR = STM32F4xx_TIM_EGR_UG;
+    // channel 1 is a frozen output compare, it only raises the interrupt
+    STM32F4xx_TIM3->CCMR1 = 0;
+    STM32F4xx_TIM3->CCER = 0;
+    STM32F4xx_TIM3->SR = 0;
+    STM32F4xx_TIM3->CR1 = STM32F4xx_TIM_CR1_CEN;
+
+    if(onewire_cfg->set_priority == TRUE)
+    {
+        stm32f4xx_set_interrupt_priority(STM32F4xx_TIM3_IRQ, onewire_cfg->priority);
+    }
+    stm32f4xx_enable_irq(STM32F4xx_TIM3_IRQ);
+
+    initialized = TRUE;
+
+    return E_OK;
+}
+
+std_return_type_t OneWireIf_deinit(void)
+{
+    if(initialized == FALSE)
+    {
+        return E_STATE_NOINIT;
+    }
+
+    STM32F4xx_TIM3->DIER = 0;
+    STM32F4xx_TIM3->CR1 = 0;
+    stm32f4xx_disable_irq(STM32F4xx_TIM3_IRQ);
+    STM32F4xx_TIM3_PCLK_DI();
+
+    port->BSRR = mask;
+    busy = FALSE;
+    initialized = FALSE;
+
+    return E_OK;
+}
+
+std_return_type_t OneWireIf_transfer(const uint8_t *tx_buffer, size_t tx_length, uint8_t *rx_buffer, size_t rx_length,
+                                     OneWireIf_callback_t cb)
+{
+    if((tx_buffer == NULL && tx_length != 0) || (rx_buffer == NULL && rx_length != 0))
+    {
+        return E_VALUE_NULL;
+    }
+    if(initialized == FALSE)
+    {
+        return E_STATE_NOINIT;
+    }
+    if(claim_bus() == FALSE)
+    {
+        return E_STATE_ERR;
+    }
+
+    tx = tx_buffer;
+    tx_bits = tx_length << 3;
+    rx = rx_buffer;
+    rx_bits = rx_length << 3;
+    callback = cb;
+    searching = FALSE;
+
+    start_transaction();
+
+    return E_OK;
+}
+
+std_return_type_t OneWireIf_search(uint64_t *rom_buffer, size_t length, size_t *found,
+                                   OneWireIf_callback_t cb)
+{
+    if(rom_buffer == NULL || found == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+    if(length == 0)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+    if(initialized == FALSE)
+    {
+        return E_STATE_NOINIT;
+    }
+    if(claim_bus() == FALSE)
+    {
+        return E_STATE_ERR;
+    }
+
+    // each search pass is a reset, the search command and 64 ROM bits
+    tx = &search_command;
+    tx_bits = 8;
+    rx = NULL;
+    rx_bits = 0;
+    callback = cb;
+    searching = TRUE;
+    roms = rom_buffer;
+    roms_length = length;
+    roms_found = found;
+    *roms_found = 0;
+    rom = 0;
+    last_discrepancy = 0;
+
+    start_transaction();
+
+    return E_OK;
+}
+
+boolean OneWireIf_busy(void)
+{
+    return busy;
+}
+
+uint8_t OneWireIf_crc8(const uint8_t *data, size_t length)
+{
+    uint8_t crc = 0;
+
+    if(data == NULL)
+    {
+        return 0;
+    }
+
+    // polynomial x^8 + x^5 + x^4 + 1, shifted in least significant bit first
+    for(size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x01) ? ((crc >> 1) ^ 0x8C) : (crc >> 1);
+        }
+    }
+
+    return crc;
+}
+
+void TIM3_Handler(void)
+{
+    // status flags are cleared by writing 0
+    STM32F4xx_TIM3->SR = (uint32_t) ~STM32F4xx_TIM_SR_CCIF(1);
+
+    const stm32f4xx_onewire_timing_t *timing = &slot_timings[slot];
+
+    switch(phase)
+    {
+    case PHASE_RELEASE:
+        port->BSRR = mask;
+        // a late release stretches the low time, the device reads it as a
+        // different slot
+        if((uint16_t) (STM32F4xx_TIM3->CNT - slot_start) > timing->max_low)
+        {
+            finish_transaction(E_ERR);
+            break;
+        }
+        if(timing->sample != 0)
+        {
+            schedule(timing->low + timing->sample);
+            phase = PHASE_SAMPLE;
+        }
+        else
+        {
+            schedule(timing->low + timing->end);
+            phase = PHASE_END;
+        }
+        break;
+    case PHASE_SAMPLE:
+        sample = (port->IDR & mask) ? 1 : 0;
+        if((uint16_t) (STM32F4xx_TIM3->CNT - slot_start) > timing->max_sample)
+        {
+            finish_transaction(E_ERR);
+            break;
+        }
+        schedule(timing->low + timing->sample + timing->end);
+        phase = PHASE_END;
+        break;
+    case PHASE_END:
+    {
+        // the callback of a finished transaction may have started the 
+        // next transaction already, its state must not be touched
+        stm32f4xx_onewire_slot_t next = next_slot();
+        if(next == SLOT_NONE)
+        {
+            break;
+        }
+        slot = next;
+    }
+        // fall through, the next slot starts at the end of this one
+    case PHASE_START:
+        port->BSRR = ((uint32_t) mask) << 16;
+        slot_start = (uint16_t) STM32F4xx_TIM3->CNT;
+        schedule(slot_timings[slot].low);
+        phase = PHASE_RELEASE;
+        break;
+    }
+}
+
+/**
+ * @brief Sets the next compare event offset microseconds after the start
+ *        of the slot
+ *
+ * If the counter has already passed the compare value, the event is 
+ * generated by software, the phase then checks whether it is too late.
+ */
+static void schedule(uint16_t offset)
+{
+    STM32F4xx_TIM3->CCR1 = (uint16_t) (slot_start + offset);
+    if((uint16_t) (STM32F4xx_TIM3->CNT - slot_start) >= offset)
+    {
+        STM32F4xx_TIM3->EGR = STM32F4xx_TIM_EGR_CCG(1);
+    }
+}
+
+/**
+ * @brief Marks the bus busy if no transaction is running
+ *
+ * The test and set runs in a critical section, so of two callers which 
+ * preempt each other only one starts a transaction. The timer interrupt
+ * only clears busy, it is not running while the bus is idle.
+ */
+static boolean claim_bus(void)
+{
+    boolean claimed = FALSE;
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
+
+    if(busy == FALSE)
+    {
+        busy = TRUE;
+        claimed = TRUE;
+    }
+    stm32f4xx_critical_exit(critical);
+
+    return claimed;
+}
+
+static void start_transaction(void)
+{
+    step = STEP_RESET;
+    slot = SLOT_RESET;
+    phase = PHASE_START;
+
+    // a stale compare flag is cleared before the compare value is set, 
+    // so it can not start the first slot early. If the counter passes
+    // the compare value in between, the event is generated by software.
+    STM32F4xx_TIM3->SR = (uint32_t) ~STM32F4xx_TIM_SR_CCIF(1);
+    slot_start = (uint16_t) STM32F4xx_TIM3->CNT;
+    schedule(STM32F4xx_ONEWIRE_START_DELAY);
+    STM32F4xx_TIM3->DIER = STM32F4xx_TIM_DIER_CCIE(1);
+}
+
+static void finish_transaction(std_return_type_t status)
+{
+    STM32F4xx_TIM3->DIER = 0;
+    busy = FALSE;
+
+    // the callback runs at the lowest priority, so the timer interrupt
+    // can run above STM32F4xx_CRITICAL_PRIORITY
+    if(callback != NULL && stm32f4xx_claim_call(&finished_call.call) == TRUE)
+    {
+        finished_call.callback = callback;
+        finished_call.status = status;
+        stm32f4xx_defer_call(&finished_call.call, callback_work);
+    }
+}
+
+static void callback_work(void *context)
+{
+    stm32f4xx_onewire_call_t *call = context;
+    OneWireIf_callback_t cb = call->callback;
+    std_return_type_t status = call->status;
+
+    // released first, the callback may start the next transaction
+    stm32f4xx_release_call(&call->call);
+    cb(status);
+}
+
+/**
+ * @brief Evaluates the finished slot and selects the next one
+ *
+ * Called from the interrupt at the end of each slot, sample holds the
+ * level of the line at the sample point of the slot.
+ */
+static stm32f4xx_onewire_slot_t next_slot(void)
+{
+    switch(step)
+    {
+    case STEP_RESET:
+        // devices answer the reset pulse by pulling the line low
+        if(sample != 0)
+        {
+            finish_transaction(E_NOT_EXISTING);
+            return SLOT_NONE;
+        }
+        bit = 0;
+        last_zero = 0;
+        return next_data_slot();
+    case STEP_WRITE:
+        bit++;
+        return next_data_slot();
+    case STEP_READ:
+    {
+        size_t rx_bit = bit - tx_bits;
+        if((rx_bit & 0x7) == 0)
+        {
+            rx[rx_bit >> 3] = 0;
+        }
+        rx[rx_bit >> 3] |= (uint8_t) (sample << (rx_bit & 0x7));
+        bit++;
+        return next_data_slot();
+    }
+    case STEP_SEARCH_ID:
+    case STEP_SEARCH_COMPLEMENT:
+    case STEP_SEARCH_DIRECTION:
+        return next_search_slot();
+    }
+
+    return SLOT_NONE;
+}
+
+static stm32f4xx_onewire_slot_t next_data_slot(void)
+{
+    if(bit < tx_bits)
+    {
+        step = STEP_WRITE;
+        return ((tx[bit >> 3] >> (bit & 0x7)) & 0x01) ? SLOT_WRITE_1 : SLOT_WRITE_0;
+    }
+
+    if(searching == TRUE)
+    {
+        bit = 0;
+        step = STEP_SEARCH_ID;
+        return SLOT_READ;
+    }
+
+    if(bit - tx_bits < rx_bits)
+    {
+        step = STEP_READ;
+        return SLOT_READ;
+    }
+
+    finish_transaction(E_OK);
+    return SLOT_NONE;
+}
+
+/**
+ * @brief One step of the ROM search
+ *
+ * Each ROM bit is read twice, as bit and as complement. If the devices
+ * disagree on a bit both reads return 0, the search then takes the 0
+ * branch first and the 1 branch in a later pass, starting from the last
+ * discrepancy where the 0 branch was taken.
+ */
+static stm32f4xx_onewire_slot_t next_search_slot(void)
+{
+    uint64_t rom_bit = ((uint64_t) 1) << bit;
+
+    switch(step)
+    {
+    case STEP_SEARCH_ID:
+        id_bit = sample;
+        step = STEP_SEARCH_COMPLEMENT;
+        return SLOT_READ;
+    case STEP_SEARCH_COMPLEMENT:
+        if(id_bit == 1 && sample == 1)
+        {
+            // no device takes part in the search
+            finish_transaction((*roms_found == 0) ? E_NOT_EXISTING : E_ERR);
+            return SLOT_NONE;
+        }
+        if(id_bit == sample)
+        {
+            // discrepancy, bit numbers start at 1 so 0 means none
+            uint8_t bit_number = (uint8_t) (bit + 1);
+            if(bit_number == last_discrepancy)
+            {
+                rom |= rom_bit;
+            }
+            else if(bit_number > last_discrepancy)
+            {
+                rom &= ~rom_bit;
+            }
+            // below the last discrepancy the previous ROM code is repeated
+
+            if((rom & rom_bit) == 0)
+            {
+                last_zero = bit_number;
+            }
+        }
+        else if(id_bit == 1)
+        {
+            rom |= rom_bit;
+        }
+        else
+        {
+            rom &= ~rom_bit;
+        }
+        step = STEP_SEARCH_DIRECTION;
+        return (rom & rom_bit) ? SLOT_WRITE_1 : SLOT_WRITE_0;
+    default:
+        break;
+    }
+
+    // direction written, the selected devices continue with the next bit
+    bit++;
+    if(bit < 64)
+    {
+        step = STEP_SEARCH_ID;
+        return SLOT_READ;
+    }
+
+    uint8_t bytes[8];
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        bytes[i] = (uint8_t) (rom >> (i << 3));
+    }
+    if(OneWireIf_crc8(bytes, 8) != 0)
+    {
+        finish_transaction(E_ERR);
+        return SLOT_NONE;
+    }
+
+    roms[(*roms_found)++] = rom;
+    last_discrepancy = last_zero;
+
+    if(last_discrepancy == 0 || *roms_found == roms_length)
+    {
+        finish_transaction(E_OK);
+        return SLOT_NONE;
+    }
+
+    // next pass
+    step = STEP_RESET;
+    return SLOT_RESET;
+}
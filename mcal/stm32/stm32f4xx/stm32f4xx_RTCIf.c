@@ -26,6 +26,16 @@ RTCIf_date_time_t *alarm_a_buffer;
 void (*alarm_b_callback)(RTCIf_date_time_t*);   
 RTCIf_date_time_t *alarm_b_buffer;
 
+// snapshot of a rung alarm for the deferred callback
+typedef struct _stm32f4xx_alarm_call
+{
+    stm32f4xx_deferred_call_t call;                     // first member, the record is the work context
+    void (*callback)(RTCIf_date_time_t*);
+    RTCIf_date_time_t *buffer;
+} stm32f4xx_alarm_call_t;
+
+static stm32f4xx_alarm_call_t alarm_calls[2] = {};
+
 static void disable_write_protection(void);
 static void enable_write_protection(void);
 static std_return_type_t enter_init_mode(void);
@@ -676,12 +686,21 @@ std_return_type_t RTCIf_set_alarm(identifier_t alarm_id, RTCIf_alarm_handle_t *a
     {
         return E_NOT_EXISTING;
     }
+    // the alarm handler reads callback and buffer, which are set in a 
+    // critical section
+    if(alarm_handle->set_priority == TRUE && !STM32F4xx_DRIVER_PRIORITY_VALID(alarm_handle->priority))
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
 
     disable_write_protection();
     std_return_type_t status = enter_init_mode();
     if(status == E_OK)
     {
         volatile STM32F4xx_RTC_ARLMxR_Regdef_t *alarm_reg;
+        // the interrupt of the other alarm shares RTC_CR and the handler,
+        // it sees the callback and buffer of an alarm only as a pair
+        stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
         if(alarm_id == 1)
         {
             STM32F4XX_RTC_REG->RTC_CR.ALRAE = 0;
@@ -698,6 +717,7 @@ std_return_type_t RTCIf_set_alarm(identifier_t alarm_id, RTCIf_alarm_handle_t *a
             alarm_b_callback = alarm_handle->callback;
             alarm_b_buffer = alarm_handle->buffer;
         }
+        stm32f4xx_critical_exit(critical);
         
         set_alarm(alarm_handle->alarm, alarm_reg);
         alarm_reg->MSK1  = alarm_handle->flags.mask_seconds;
@@ -706,6 +726,7 @@ std_return_type_t RTCIf_set_alarm(identifier_t alarm_id, RTCIf_alarm_handle_t *a
         alarm_reg->MSK4  = alarm_handle->flags.mask_date;
         alarm_reg->WDSEL = alarm_handle->flags.use_day_of_week;
 
+        critical = stm32f4xx_critical_enter();
         if(alarm_id == 1)
         {
             STM32F4XX_RTC_REG->RTC_CR.ALRAE  = 1;
@@ -716,11 +737,17 @@ std_return_type_t RTCIf_set_alarm(identifier_t alarm_id, RTCIf_alarm_handle_t *a
             STM32F4XX_RTC_REG->RTC_CR.ALRBE  = 1;
             STM32F4XX_RTC_REG->RTC_CR.ALRBIE = 1;
         }
+        stm32f4xx_critical_exit(critical);
 
         // enable interrupt flags
-        STM32F4xx_EXTI->EXTI_IMR    |=  (0x1 << 17);
-        STM32F4xx_EXTI->EXTI_RTSR   |=  (0x1 << 17);
-        stm32f4xx_enable_interrupt(STM32F4xx_EXTI17_RTC_ALARM_IRQ);
+        STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_IMR, 17)  = 1;
+        STM32F4xx_BITBAND(STM32F4xx_EXTI->EXTI_RTSR, 17) = 1;
+        // both alarms share one IRQ
+        if(alarm_handle->set_priority == TRUE)
+        {
+            stm32f4xx_set_interrupt_priority(STM32F4xx_EXTI17_RTC_ALARM_IRQ, alarm_handle->priority);
+        }
+        stm32f4xx_enable_irq(STM32F4xx_EXTI17_RTC_ALARM_IRQ);
 
         leave_init_mode();
     }   
@@ -732,6 +759,14 @@ std_return_type_t RTCIf_set_alarm(identifier_t alarm_id, RTCIf_alarm_handle_t *a
 
 std_return_type_t RTCIf_clear_alarm(identifier_t alarm_id)
 {
+    if(alarm_id <= 0 || alarm_id > 2)
+    {
+        return E_NOT_EXISTING;
+    }
+
+    // the state of the other alarm is checked without preemption by its
+    // configuration
+    stm32f4xx_critical_t critical = stm32f4xx_critical_enter();
     if(alarm_id == 1)
     {
         STM32F4XX_RTC_REG->RTC_CR.ALRAE = 0;
@@ -739,7 +774,7 @@ std_return_type_t RTCIf_clear_alarm(identifier_t alarm_id)
 
         if(STM32F4XX_RTC_REG->RTC_CR.ALRBE == 0)
         {
-            stm32f4xx_disable_interrupt(STM32F4xx_EXTI17_RTC_ALARM_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_EXTI17_RTC_ALARM_IRQ);
         }
     }
     else if(alarm_id == 2)
@@ -749,20 +784,47 @@ std_return_type_t RTCIf_clear_alarm(identifier_t alarm_id)
 
         if(STM32F4XX_RTC_REG->RTC_CR.ALRAE == 0)
         {
-            stm32f4xx_disable_interrupt(STM32F4xx_EXTI17_RTC_ALARM_IRQ);
+            stm32f4xx_disable_irq(STM32F4xx_EXTI17_RTC_ALARM_IRQ);
         }
     }
-    else
-    {
-        return E_NOT_EXISTING;
-    }
+    stm32f4xx_critical_exit(critical);
+
     return E_OK;
 }
 
 
+static void alarm_work(void *context)
+{
+    stm32f4xx_alarm_call_t *call = context;
+    void (*callback)(RTCIf_date_time_t*) = call->callback;
+    RTCIf_date_time_t *buffer = call->buffer;
+
+    stm32f4xx_release_call(&call->call);
+    callback(buffer);
+}
+
+/**
+ * @brief Queues an alarm callback with the callback and buffer which
+ *        were set when the alarm rang
+ *
+ * The timestamp is taken in the interrupt, the callback runs at the 
+ * lowest interrupt priority.
+ */
+static void defer_alarm(stm32f4xx_alarm_call_t *call, void (*callback)(RTCIf_date_time_t*),
+                        RTCIf_date_time_t *buffer)
+{
+    if(callback != NULL && stm32f4xx_claim_call(&call->call) == TRUE)
+    {
+        call->callback = callback;
+        call->buffer = buffer;
+        stm32f4xx_defer_call(&call->call, alarm_work);
+    }
+}
+
 void EXTI17_RTC_ALARM_Handler()
 {
-    STM32F4xx_EXTI->EXTI_PR |= (1 << 17) ;
+    // write-1-to-clear, only acknowledge the alarm line
+    STM32F4xx_EXTI->EXTI_PR = (1UL << 17);
     if(STM32F4XX_RTC_REG->RTC_ISR.ALRAF == 1)
     {
         STM32F4XX_RTC_REG->RTC_ISR.ALRAF = 0; 
@@ -770,7 +832,7 @@ void EXTI17_RTC_ALARM_Handler()
         {
             (void) RTCIf_get_date_time(alarm_a_buffer);
         }
-        alarm_a_callback(alarm_a_buffer);
+        defer_alarm(&alarm_calls[0], alarm_a_callback, alarm_a_buffer);
     }
     else if(STM32F4XX_RTC_REG->RTC_ISR.ALRBF == 1)
     {
@@ -779,6 +841,6 @@ void EXTI17_RTC_ALARM_Handler()
         {
             (void) RTCIf_get_date_time(alarm_b_buffer);
         }
-        alarm_b_callback(alarm_a_buffer);
+        defer_alarm(&alarm_calls[1], alarm_b_callback, alarm_b_buffer);
     }
 }
\ No newline at end of file
@@ -0,0 +1,336 @@
+/**
+ * @file stm32f4xx_SoftPwmIf.c
+ * @author Christoph Lehr
+ * @date 16 Oct 2026
+ * @brief STM32F4xx implementation of the software PWM API
+ *
+ * This file implements the generic software PWM API for the
+ * STM32F4xx series. TIM2 counts the steps of a period, its
+ * compare channel 1 is moved from event to event of a sorted
+ * schedule. Each event is one BSRR word of a port, channels of
+ * a port which switch at the same step share one event.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "datatypes.h"
+#include "GPIOIf.h"
+#include "SoftPwmIf.h"
+#include "SysClockIf.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_interrupt.h"
+
+#ifndef STM32F4xx_SOFTPWM_CHANNELS
+#define STM32F4xx_SOFTPWM_CHANNELS          16
+#endif
+
+// one event per channel plus the start event of each port
+#define STM32F4xx_SOFTPWM_EVENTS            (STM32F4xx_SOFTPWM_CHANNELS + 8)
+
+typedef struct _stm32f4xx_softpwm_event
+{
+    uint32_t time;                                  // step of the period
+    STM32F4xx_GPIO_RegDef_t *port;
+    uint32_t bsrr;                                  // word written to BSRR of port
+} stm32f4xx_softpwm_event_t;
+
+typedef struct _stm32f4xx_softpwm_schedule
+{
+    uint8_t count;
+    stm32f4xx_softpwm_event_t events[STM32F4xx_SOFTPWM_EVENTS];
+} stm32f4xx_softpwm_schedule_t;
+
+typedef struct _stm32f4xx_softpwm_channel
+{
+    GPIOIf_pin_t pin;
+    uint16_t duty;
+    boolean used;
+} stm32f4xx_softpwm_channel_t;
+
+static char timer_clock[] = "APB1 Timer";
+
+static boolean initialized = FALSE;
+static uint16_t steps = 0;
+static stm32f4xx_softpwm_channel_t channels[STM32F4xx_SOFTPWM_CHANNELS] = {};
+
+// the interrupt executes the active schedule and switches to the pending
+// one at the beginning of a period, the other schedule is built by the API
+static stm32f4xx_softpwm_schedule_t schedules[2] = {};
+static stm32f4xx_softpwm_schedule_t * volatile active_schedule = &schedules[0];
+static stm32f4xx_softpwm_schedule_t * volatile pending_schedule = NULL;
+static uint8_t event_index = 0;
+
+static void update_schedule(void);
+static void add_event(stm32f4xx_softpwm_schedule_t *schedule, uint32_t time,
+                      STM32F4xx_GPIO_RegDef_t *port, uint32_t bsrr);
+
+std_return_type_t SoftPwmIf_init(uint32_t frequency, uint16_t resolution)
+{
+    if(initialized == TRUE)
+    {
+        return E_STATE_INIT;
+    }
+
+    identifier_t clock_id = SysClockIf_get_clock_id(timer_clock);
+    uint32_t timer_frequency = SysClockIf_get_clock_frequency(clock_id);
+    uint64_t step_frequency = (uint64_t) frequency * resolution;
+
+    if(frequency == 0 || resolution == 0 || step_frequency > timer_frequency)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    uint32_t prescaler = (uint32_t) (timer_frequency / step_frequency) - 1;
+    if(prescaler > 0xFFFF)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    for(uint8_t i = 0; i < STM32F4xx_SOFTPWM_CHANNELS; i++)
+    {
+        channels[i].used = FALSE;
+    }
+    steps = resolution;
+    schedules[0].count = 0;
+    active_schedule = &schedules[0];
+    pending_schedule = NULL;
+    event_index = 0;
+    initialized = TRUE;
+
+    STM32F4xx_TIM2_PCLK_EN();
+
+    STM32F4xx_TIM2->CR1 = 0;
+    STM32F4xx_TIM2->PSC = prescaler;
+    STM32F4xx_TIM2->ARR = resolution - 1;
+    STM32F4xx_TIM2->CNT = 0;
+    STM32F4xx_TIM2->EGR = STM32F4xx_TIM_EGR_UG;
+    // channel 1 is a frozen output compare, it only raises the interrupt
+    STM32F4xx_TIM2->CCMR1 = 0;
+    STM32F4xx_TIM2->CCER = 0;
+    STM32F4xx_TIM2->CCR1 = 0;
+    STM32F4xx_TIM2->SR = 0;
+    STM32F4xx_TIM2->CR1 = STM32F4xx_TIM_CR1_CEN;
+
+    stm32f4xx_enable_irq(STM32F4xx_TIM2_IRQ);
+
+    return E_OK;
+}
+
+std_return_type_t SoftPwmIf_deinit(void)
+{
+    if(initialized == FALSE)
+    {
+        return E_STATE_NOINIT;
+    }
+
+    STM32F4xx_TIM2->DIER = 0;
+    STM32F4xx_TIM2->CR1 = 0;
+    stm32f4xx_disable_irq(STM32F4xx_TIM2_IRQ);
+    STM32F4xx_TIM2_PCLK_DI();
+
+    initialized = FALSE;
+
+    return E_OK;
+}
+
+std_return_type_t SoftPwmIf_set_duty(GPIOIf_pin_t pin, uint16_t duty)
+{
+    stm32f4xx_softpwm_channel_t *channel = NULL;
+
+    if(initialized == FALSE)
+    {
+        return E_STATE_NOINIT;
+    }
+    if(FALSE == stm32f4xx_GPIO_pin_exists(pin))
+    {
+        return E_NOT_EXISTING;
+    }
+    if(duty > steps)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    for(uint8_t i = 0; i < STM32F4xx_SOFTPWM_CHANNELS; i++)
+    {
+        if(channels[i].used == TRUE && channels[i].pin == pin)
+        {
+            channel = &channels[i];
+            break;
+        }
+        if(channels[i].used == FALSE && channel == NULL)
+        {
+            channel = &channels[i];
+        }
+    }
+    if(channel == NULL)
+    {
+        return E_NOT_SUPPORTED;
+    }
+
+    channel->pin = pin;
+    channel->duty = duty;
+    channel->used = TRUE;
+
+    update_schedule();
+
+    return E_OK;
+}
+
+std_return_type_t SoftPwmIf_remove_pin(GPIOIf_pin_t pin)
+{
+    if(initialized == FALSE)
+    {
+        return E_STATE_NOINIT;
+    }
+
+    for(uint8_t i = 0; i < STM32F4xx_SOFTPWM_CHANNELS; i++)
+    {
+        if(channels[i].used == TRUE && channels[i].pin == pin)
+        {
+            channels[i].used = FALSE;
+            update_schedule();
+            return E_OK;
+        }
+    }
+
+    return E_NOT_EXISTING;
+}
+
+void TIM2_Handler(void)
+{
+    stm32f4xx_softpwm_schedule_t *schedule = active_schedule;
+    uint8_t index = event_index;
+
+    // status flags are cleared by writing 0
+    STM32F4xx_TIM2->SR = (uint32_t) ~STM32F4xx_TIM_SR_CCIF(1);
+
+    // a new schedule is taken at the beginning of a period only
+    if(index == 0 && pending_schedule != NULL)
+    {
+        schedule = pending_schedule;
+        active_schedule = schedule;
+        pending_schedule = NULL;
+    }
+
+    if(schedule->count == 0)
+    {
+        STM32F4xx_TIM2->DIER = 0;
+        STM32F4xx_TIM2->CCR1 = 0;
+        return;
+    }
+
+    // events which are due already, because they follow closer than the
+    // interrupt latency, are executed in the same interrupt
+    do
+    {
+        schedule->events[index].port->BSRR = schedule->events[index].bsrr;
+        index++;
+
+        if(index == schedule->count)
+        {
+            index = 0;
+            break;
+        }
+    } while(schedule->events[index].time <= STM32F4xx_TIM2->CNT);
+
+    event_index = index;
+    STM32F4xx_TIM2->CCR1 = schedule->events[index].time;
+}
+
+static void update_schedule(void)
+{
+    // take back the pending schedule, the interrupt can not switch to it
+    // while it is rebuilt
+    (void) __atomic_exchange_n(&pending_schedule, NULL, __ATOMIC_ACQ_REL);
+    stm32f4xx_softpwm_schedule_t *schedule = (active_schedule == &schedules[0]) ? &schedules[1] : &schedules[0];
+    uint16_t set_masks[8] = {};
+    uint16_t clear_masks[8] = {};
+    uint8_t ports_used = 0;
+
+    schedule->count = 0;
+
+    // every channel starts the period high, unless its duty cycle is 0
+    for(uint8_t i = 0; i < STM32F4xx_SOFTPWM_CHANNELS; i++)
+    {
+        if(channels[i].used == FALSE)
+        {
+            continue;
+        }
+        uint8_t port_number = (uint8_t) GPIOIf_get_port_number(channels[i].pin);
+        uint16_t mask = (uint16_t) (1 << GPIOIf_get_pin_number(channels[i].pin));
+
+        ports_used |= (1 << port_number);
+        if(channels[i].duty == 0)
+        {
+            clear_masks[port_number] |= mask;
+        }
+        else
+        {
+            set_masks[port_number] |= mask;
+        }
+    }
+
+    for(uint8_t port_number = 0; port_number < 8; port_number++)
+    {
+        if(ports_used & (1 << port_number))
+        {
+            add_event(schedule, 0, STM32F4xx_GPIO_PORT_REG(port_number << 8),
+                      ((uint32_t) clear_masks[port_number] << 16) | set_masks[port_number]);
+        }
+    }
+
+    // end of the high phase, channels with a duty cycle of 0 or 100% do
+    // not switch within the period
+    for(uint8_t i = 0; i < STM32F4xx_SOFTPWM_CHANNELS; i++)
+    {
+        if(channels[i].used == FALSE || channels[i].duty == 0 || channels[i].duty == steps)
+        {
+            continue;
+        }
+        add_event(schedule, channels[i].duty, STM32F4xx_GPIO_PORT_REG(channels[i].pin),
+                  (uint32_t) STM32F4xx_GPIO_PIN_MASK(channels[i].pin) << 16);
+    }
+
+    __atomic_store_n(&pending_schedule, schedule, __ATOMIC_RELEASE);
+
+    // the interrupt is disabled while there is no event. The compare flag
+    // is set at every overflow meanwhile and would start the schedule in
+    // the middle of the period. A flag of a running schedule has set the
+    // interrupt pending already, clearing it does not lose the event.
+    if(schedule->count != 0)
+    {
+        STM32F4xx_TIM2->SR = (uint32_t) ~STM32F4xx_TIM_SR_CCIF(1);
+        STM32F4xx_TIM2->DIER = STM32F4xx_TIM_DIER_CCIE(1);
+    }
+}
+
+static void add_event(stm32f4xx_softpwm_schedule_t *schedule, uint32_t time,
+                      STM32F4xx_GPIO_RegDef_t *port, uint32_t bsrr)
+{
+    uint8_t index = 0;
+
+    // merge with an event of the same port and time, else insert sorted
+    for(; index < schedule->count; index++)
+    {
+        stm32f4xx_softpwm_event_t *event = &schedule->events[index];
+        if(event->time == time && event->port == port)
+        {
+            event->bsrr |= bsrr;
+            return;
+        }
+        if(event->time > time)
+        {
+            break;
+        }
+    }
+
+    for(uint8_t i = schedule->count; i > index; i--)
+    {
+        schedule->events[i] = schedule->events[i - 1];
+    }
+    schedule->events[index].time = time;
+    schedule->events[index].port = port;
+    schedule->events[index].bsrr = bsrr;
+    schedule->count++;
+}
+
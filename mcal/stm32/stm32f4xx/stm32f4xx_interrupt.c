@@ -8,18 +8,56 @@
  * interrupt configuration
  */
 
+#include <stddef.h>
 #include "datatypes.h"
 #include "stm32f4xx_interrupt.h"
 #include "stm32f4xx.h"
 
 boolean stm32f4xx_irq_exists(STM32F4xx_IRQ_t irq);
 
-// unused IRQ IDs
-uint8_t unused_IRQs[] = {19, 20, 21,22, 39, 42, 43, 44, 45, 46, 48, 61, 62, 63, 64, 65, 66, 74,75,76,77,78,79,80};
+// existing IRQs, one bit per IRQ
+static const uint32_t IRQ_bitmap[3] = {STM32F4xx_IRQ_BITMAP_0, STM32F4xx_IRQ_BITMAP_1, STM32F4xx_IRQ_BITMAP_2};
+
+_Static_assert(STM32F4xx_IRQ_EXISTS(STM32F4xx_WWDG_IRQ) && STM32F4xx_IRQ_EXISTS(STM32F4xx_EXTI18_OTG_FS_WKUP_IRQ) &&
+               STM32F4xx_IRQ_EXISTS(STM32F4xx_SPI5_IRQ) && !STM32F4xx_IRQ_EXISTS(39) && !STM32F4xx_IRQ_EXISTS(86),
+               "IRQ bitmap does not match STM32F4xx_IRQ_t");
 
 // stack pointer location
 extern uint32_t _estack;
 
+// copy of the vector table in SRAM, VTOR requires the table size rounded 
+// up to a power of 2 as alignment (102 vectors -> 512 bytes)
+static void *ram_vectors[STM32F4xx_VECTOR_COUNT] __attribute__((aligned(512)));
+static boolean vectors_relocated = FALSE;
+
+_Static_assert(sizeof(DeviceVectors) == sizeof(ram_vectors), "DeviceVectors does not match STM32F4xx_VECTOR_COUNT");
+
+#if (STM32F4xx_DEFERRED_WORK_SIZE & (STM32F4xx_DEFERRED_WORK_SIZE - 1)) != 0
+#error "STM32F4xx_DEFERRED_WORK_SIZE has to be a power of two"
+#endif
+
+typedef struct _stm32f4xx_work_slot
+{
+    volatile stm32f4xx_work_t fn;                   // NULL marks a free or not yet written slot
+    void *context;
+} stm32f4xx_work_slot_t;
+
+// multiple producer (any interrupt) single consumer (PendSV) queue, 
+// producers reserve a slot by an atomic increment of head and publish it 
+// by writing fn. The consumer stops at the first slot which is reserved
+// but not yet written.
+typedef struct _stm32f4xx_work_queue
+{
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    stm32f4xx_work_slot_t slots[STM32F4xx_DEFERRED_WORK_SIZE];
+} stm32f4xx_work_queue_t;
+
+static stm32f4xx_work_queue_t deferred_work = {};
+static uint32_t dropped_calls = 0;
+
+static STM32F4xx_ISR_RAMFUNC std_return_type_t queue_work(stm32f4xx_work_t fn, void *context, uint32_t limit);
+
 /* Exception Table */
 __attribute__ ((section(".vectors")))
 const DeviceVectors exception_table = {
@@ -103,10 +141,7 @@ std_return_type_t stm32f4xx_enable_interrupt(STM32F4xx_IRQ_t irq)
         return E_VALUE_ERR;
     }
 
-    uint8_t reg_no = irq >> 5;      // devide by 32 to get NVIC register number 
-    uint8_t reg_pos = irq & 0x1F;   // 32-1, mask out last 5 bits to get position inside register
-
-    STM32F4xx_NVIC->NVIC_ISER[reg_no] |= (1 << reg_pos);
+    stm32f4xx_enable_irq(irq);
 
     return E_OK;
 }
@@ -118,28 +153,257 @@ std_return_type_t stm32f4xx_disable_interrupt(STM32F4xx_IRQ_t irq)
         return E_VALUE_ERR;
     }
 
-    uint8_t reg_no = irq >> 5;      // devide by 32 to get NVIC register number 
-    uint8_t reg_pos = irq & 0x1F;   // 32-1, mask out last 5 bits to get position inside register
+    stm32f4xx_disable_irq(irq);
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_set_interrupt_priority(STM32F4xx_IRQ_t irq, uint8_t priority)
+{
+    if(stm32f4xx_irq_exists(irq) == FALSE)
+    {
+        return E_VALUE_ERR;
+    }
+    if(priority > STM32F4xx_NVIC_MAX_PRIORITY)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    // one priority byte per IRQ, only the upper bits are implemented. 
+    // A byte store leaves the priorities of the other IRQs untouched.
+    volatile uint8_t *ipr = (volatile uint8_t *) STM32F4xx_NVIC->NVIC_IPR0;
+    ipr[irq] = (uint8_t) (priority << (8 - STM32F4xx_NVIC_PRIO_BITS));
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_get_interrupt_priority(STM32F4xx_IRQ_t irq, uint8_t *priority)
+{
+    if(stm32f4xx_irq_exists(irq) == FALSE)
+    {
+        return E_VALUE_ERR;
+    }
+    if(priority == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+
+    volatile uint8_t *ipr = (volatile uint8_t *) STM32F4xx_NVIC->NVIC_IPR0;
+    *priority = ipr[irq] >> (8 - STM32F4xx_NVIC_PRIO_BITS);
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_set_priority_grouping(uint8_t preemption_bits)
+{
+    if(preemption_bits > STM32F4xx_NVIC_PRIO_BITS)
+    {
+        return E_VALUE_OUT_OF_RANGE;
+    }
+
+    // PRIGROUP is the number of the highest subpriority bit of the 
+    // priority byte, of which only the upper STM32F4xx_NVIC_PRIO_BITS exist
+    uint32_t prigroup = 7 - preemption_bits;
+    uint32_t aircr = STM32F4xx_SCB->SCB_AIRCR;
+    aircr &= ~(STM32F4xx_SCB_AIRCR_VECTKEY_MASK | STM32F4xx_SCB_AIRCR_PRIGROUP_MASK);
+    STM32F4xx_SCB->SCB_AIRCR = aircr | STM32F4xx_SCB_AIRCR_VECTKEY | (prigroup << STM32F4xx_SCB_AIRCR_PRIGROUP_POS);
+
+    return E_OK;
+}
+
+uint8_t stm32f4xx_get_priority_grouping(void)
+{
+    uint32_t prigroup = (STM32F4xx_SCB->SCB_AIRCR & STM32F4xx_SCB_AIRCR_PRIGROUP_MASK) >> STM32F4xx_SCB_AIRCR_PRIGROUP_POS;
+
+    // groups with less than 4 subpriority bits of the byte all have 4 
+    // preemption bits
+    return (prigroup < (8 - STM32F4xx_NVIC_PRIO_BITS)) ? STM32F4xx_NVIC_PRIO_BITS : (uint8_t) (7 - prigroup);
+}
+
+std_return_type_t stm32f4xx_relocate_vector_table(void)
+{
+    if(vectors_relocated == TRUE)
+    {
+        return E_STATE_INIT;
+    }
+
+    void * const *flash_vectors = (void * const *) &exception_table;
+    for(uint8_t i = 0; i < STM32F4xx_VECTOR_COUNT; i++)
+    {
+        ram_vectors[i] = flash_vectors[i];
+    }
+
+    // the copy is complete before the core fetches vectors from it
+    STM32F4xx_DSB();
+    STM32F4xx_SCB->SCB_VTOR = (uint32_t) (uintptr_t) ram_vectors;
+    STM32F4xx_DSB();
+    STM32F4xx_ISB();
+
+    vectors_relocated = TRUE;
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_register_irq_handler(STM32F4xx_IRQ_t irq, void (*handler)(void))
+{
+    if(stm32f4xx_irq_exists(irq) == FALSE)
+    {
+        return E_VALUE_ERR;
+    }
+    if(handler == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+
+    if(vectors_relocated == FALSE)
+    {
+        (void) stm32f4xx_relocate_vector_table();
+    }
+
+    // a single word store, the interrupt fetches either the old or the 
+    // new handler
+    ram_vectors[16 + irq] = (void *) handler;
+    STM32F4xx_DSB();
+
+    return E_OK;
+}
+
+std_return_type_t stm32f4xx_restore_irq_handler(STM32F4xx_IRQ_t irq)
+{
+    if(stm32f4xx_irq_exists(irq) == FALSE)
+    {
+        return E_VALUE_ERR;
+    }
 
-    STM32F4xx_NVIC->NVIC_ICER[reg_no] |= (1 << reg_pos);
+    // the flash table is in use until a handler is registered
+    if(vectors_relocated == FALSE)
+    {
+        return E_OK;
+    }
+
+    void * const *flash_vectors = (void * const *) &exception_table;
+    ram_vectors[16 + irq] = flash_vectors[16 + irq];
+    STM32F4xx_DSB();
 
     return E_OK;
 }
 
 boolean stm32f4xx_irq_exists(STM32F4xx_IRQ_t irq)
 {
-    if(irq > STM32F4xx_STM32F4XX_MAX_IRQ)
+    if((uint32_t) irq > STM32F4xx_STM32F4XX_MAX_IRQ)
     {
         return FALSE;
     }
 
-    uint8_t len = sizeof(unused_IRQs);
-    for(uint8_t i =0; i < len; i++)
+    return ((IRQ_bitmap[(uint32_t) irq >> 5] >> ((uint32_t) irq & 0x1F)) & 0x1) ? TRUE : FALSE;
+}
+
+std_return_type_t stm32f4xx_defer_work(stm32f4xx_work_t fn, void *context)
+{
+    return queue_work(fn, context, STM32F4xx_DEFERRED_WORK_SIZE - STM32F4xx_DEFERRED_WORK_RESERVED);
+}
+
+// called by the EXTI handlers, placed in SRAM with them
+STM32F4xx_ISR_RAMFUNC std_return_type_t stm32f4xx_defer_reserved_work(stm32f4xx_work_t fn, void *context)
+{
+    return queue_work(fn, context, STM32F4xx_DEFERRED_WORK_SIZE);
+}
+
+/**
+ * @brief Queues a work item if less than limit slots are used
+ *
+ * The limit is checked against the head which the compare and swap 
+ * succeeds with, so concurrent producers can not exceed it.
+ */
+static STM32F4xx_ISR_RAMFUNC std_return_type_t queue_work(stm32f4xx_work_t fn, void *context, uint32_t limit)
+{
+    if(fn == NULL)
+    {
+        return E_VALUE_NULL;
+    }
+
+    uint32_t head = __atomic_load_n(&deferred_work.head, __ATOMIC_RELAXED);
+
+    do
     {
-        if(unused_IRQs[i] == irq)
+        if(head - __atomic_load_n(&deferred_work.tail, __ATOMIC_ACQUIRE) >= limit)
         {
-            return FALSE;
+            return E_STATE_ERR;
         }
+    } while(!__atomic_compare_exchange_n(&deferred_work.head, &head, head + 1, TRUE, 
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    stm32f4xx_work_slot_t *slot = &deferred_work.slots[head & (STM32F4xx_DEFERRED_WORK_SIZE - 1)];
+    slot->context = context;
+    // release: the slot is complete before it is published
+    __atomic_store_n(&slot->fn, fn, __ATOMIC_RELEASE);
+
+    STM32F4xx_SCB->SCB_ICSR = STM32F4xx_SCB_ICSR_PENDSVSET;
+
+    return E_OK;
+}
+
+boolean stm32f4xx_claim_call(stm32f4xx_deferred_call_t *call)
+{
+    if(__atomic_exchange_n(&call->queued, TRUE, __ATOMIC_ACQUIRE) == TRUE)
+    {
+        __atomic_fetch_add(&dropped_calls, 1, __ATOMIC_RELAXED);
+        return FALSE;
     }
+
     return TRUE;
-}
\ No newline at end of file
+}
+
+void stm32f4xx_defer_call(stm32f4xx_deferred_call_t *call, stm32f4xx_work_t fn)
+{
+    if(stm32f4xx_defer_work(fn, call) != E_OK)
+    {
+        stm32f4xx_release_call(call);
+        __atomic_fetch_add(&dropped_calls, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void stm32f4xx_release_call(stm32f4xx_deferred_call_t *call)
+{
+    // release: the snapshot is read before the record can be claimed again
+    __atomic_store_n(&call->queued, FALSE, __ATOMIC_RELEASE);
+}
+
+uint32_t stm32f4xx_get_dropped_calls(void)
+{
+    return __atomic_load_n(&dropped_calls, __ATOMIC_RELAXED);
+}
+
+uint32_t stm32f4xx_run_deferred_work(void)
+{
+    uint32_t tail = deferred_work.tail;
+    uint32_t count = 0;
+
+    while(1)
+    {
+        stm32f4xx_work_slot_t *slot = &deferred_work.slots[tail & (STM32F4xx_DEFERRED_WORK_SIZE - 1)];
+        // acquire: the context is read after the fn which published it
+        stm32f4xx_work_t fn = __atomic_load_n(&slot->fn, __ATOMIC_ACQUIRE);
+        if(fn == NULL)
+        {
+            break;
+        }
+        void *context = slot->context;
+
+        // hand the slot back before the item runs, so the item can queue
+        // further work
+        slot->fn = NULL;
+        tail++;
+        __atomic_store_n(&deferred_work.tail, tail, __ATOMIC_RELEASE);
+        count++;
+
+        fn(context);
+    }
+
+    return count;
+}
+
+void PendSV_Handler(void)
+{
+    (void) stm32f4xx_run_deferred_work();
+}
@@ -11,7 +11,9 @@
 #ifndef STM32F4xx_INTERRUPT_STM32F411XX_H
 #define STM32F4xx_INTERRUPT_STM32F411XX_H
 
+#include <stdint.h>
 #include "datatypes.h"
+#include "stm32f4xx.h"
 
 // Interrup vectors, stack pointer etc.
 typedef struct _DeviceVectors
@@ -264,12 +266,183 @@ typedef enum
 
 #define STM32F4xx_STM32F4XX_MAX_IRQ  85
 
+// 16 core exceptions followed by the IRQs
+#define STM32F4xx_VECTOR_COUNT       (16 + STM32F4xx_STM32F4XX_MAX_IRQ + 1)
+
+// interrupt handlers of the drivers are placed in SRAM if 
+// STM32F4xx_ISR_IN_RAM is defined. Only the EXTI handlers of the GPIO
+// driver and the deferred work queue functions they call are marked, 
+// callbacks registered by the application stay in flash unless they are
+// marked with STM32F4xx_RAMFUNC themselves. The linker script has to copy
+// .data.ramfunc to SRAM with .data, see STM32F4xx_RAMFUNC. Check this in
+// the script used by the Makefile (mcal/swarm-os.ld) before defining
+// STM32F4xx_ISR_IN_RAM, otherwise the handlers are called at an SRAM
+// address which holds no code.
+#ifdef STM32F4xx_ISR_IN_RAM
+#define STM32F4xx_ISR_RAMFUNC        STM32F4xx_RAMFUNC
+#else
+#define STM32F4xx_ISR_RAMFUNC
+#endif
+
+// existing IRQs as bitmap, bit (irq & 0x1F) of word (irq >> 5): 0-18,
+// 23-38, 40-42, 47, 49-51, 56-60, 67-73, 81, 84 and 85
+#define STM32F4xx_IRQ_BITMAP_0       0xFF87FFFFUL
+#define STM32F4xx_IRQ_BITMAP_1       0x1F0E877FUL
+#define STM32F4xx_IRQ_BITMAP_2       0x003203F8UL
+
+// constant expression, may be used in static assertions
+#define STM32F4xx_IRQ_EXISTS(irq) \
+    ((uint32_t) (irq) <= STM32F4xx_STM32F4XX_MAX_IRQ && \
+     (((((uint32_t) (irq) >> 5) == 0) ? STM32F4xx_IRQ_BITMAP_0 : \
+       (((uint32_t) (irq) >> 5) == 1) ? STM32F4xx_IRQ_BITMAP_1 : STM32F4xx_IRQ_BITMAP_2) >> ((irq) & 0x1F)) & 0x1)
+
+// implemented priority bits, priorities range from 0 (highest) to 15
+#define STM32F4xx_NVIC_PRIO_BITS     4
+#define STM32F4xx_NVIC_MAX_PRIORITY  ((1 << STM32F4xx_NVIC_PRIO_BITS) - 1)
+
+// critical sections hold off all interrupts with a priority value of at 
+// least STM32F4xx_CRITICAL_PRIORITY, more urgent interrupts keep running 
+// and must not touch driver state. Reset_Handler starts all IRQs with 
+// this priority.
+#ifndef STM32F4xx_CRITICAL_PRIORITY
+#define STM32F4xx_CRITICAL_PRIORITY  4
+#endif
+
+_Static_assert(STM32F4xx_CRITICAL_PRIORITY > 0 && STM32F4xx_CRITICAL_PRIORITY <= STM32F4xx_NVIC_MAX_PRIORITY,
+               "BASEPRI can not mask priority 0");
+
+// priorities of interrupts which share state with their driver, i.e. 
+// which the critical sections of the driver have to hold off
+#define STM32F4xx_DRIVER_PRIORITY_VALID(priority) \
+    ((priority) >= STM32F4xx_CRITICAL_PRIORITY && (priority) <= STM32F4xx_NVIC_MAX_PRIORITY)
+
+// priority of a preemption group and the subpriority within the group, 
+// preemption_bits as passed to stm32f4xx_set_priority_grouping()
+#define STM32F4xx_NVIC_PRIORITY(preemption, sub, preemption_bits) \
+    ((uint8_t) (((preemption) << (STM32F4xx_NVIC_PRIO_BITS - (preemption_bits))) | \
+                ((sub) & ((1 << (STM32F4xx_NVIC_PRIO_BITS - (preemption_bits))) - 1))))
+
 std_return_type_t stm32f4xx_enable_interrupt(STM32F4xx_IRQ_t irq);
 
 std_return_type_t stm32f4xx_disable_interrupt(STM32F4xx_IRQ_t irq);
 
+// unchecked variants for IRQs known to exist, i.e. constants and tables 
+// of a driver. ISER and ICER are write-one registers, the single store 
+// leaves all other IRQs untouched.
+STM32F4xx_ALWAYS_INLINE void stm32f4xx_enable_irq(STM32F4xx_IRQ_t irq)
+{
+    STM32F4xx_NVIC->NVIC_ISER[(uint32_t) irq >> 5] = 1UL << ((uint32_t) irq & 0x1F);
+}
+
+STM32F4xx_ALWAYS_INLINE void stm32f4xx_disable_irq(STM32F4xx_IRQ_t irq)
+{
+    STM32F4xx_NVIC->NVIC_ICER[(uint32_t) irq >> 5] = 1UL << ((uint32_t) irq & 0x1F);
+}
+
+// priority 0 to STM32F4xx_NVIC_MAX_PRIORITY, lower values preempt higher ones
 std_return_type_t stm32f4xx_set_interrupt_priority(STM32F4xx_IRQ_t irq, uint8_t priority);
 
+std_return_type_t stm32f4xx_get_interrupt_priority(STM32F4xx_IRQ_t irq, uint8_t *priority);
+
+// splits the priority in preemption_bits upper bits, which decide on 
+// preemption, and the remaining lower bits, which only order pending 
+// interrupts of the same preemption group. 0 to STM32F4xx_NVIC_PRIO_BITS,
+// the reset value is STM32F4xx_NVIC_PRIO_BITS, i.e. no subpriority
+std_return_type_t stm32f4xx_set_priority_grouping(uint8_t preemption_bits);
+
+uint8_t stm32f4xx_get_priority_grouping(void);
+
+// previous mask of a critical section
+typedef uint32_t stm32f4xx_critical_t;
+
+// enters a critical section, returns the previous mask which has to be 
+// passed to stm32f4xx_critical_exit(). Sections nest, BASEPRI_MAX only 
+// raises the mask, i.e. an inner section never lowers an outer one.
+STM32F4xx_ALWAYS_INLINE stm32f4xx_critical_t stm32f4xx_critical_enter(void)
+{
+    stm32f4xx_critical_t basepri;
+
+    __asm volatile ("mrs %0, basepri" : "=r" (basepri));
+    __asm volatile ("msr basepri_max, %0" 
+                    :: "r" (STM32F4xx_CRITICAL_PRIORITY << (8 - STM32F4xx_NVIC_PRIO_BITS)) : "memory");
+
+    return basepri;
+}
+
+STM32F4xx_ALWAYS_INLINE void stm32f4xx_critical_exit(stm32f4xx_critical_t basepri)
+{
+    __asm volatile ("msr basepri, %0" :: "r" (basepri) : "memory");
+}
+
+// number of work items which can be queued, power of two
+#ifndef STM32F4xx_DEFERRED_WORK_SIZE
+#define STM32F4xx_DEFERRED_WORK_SIZE    16
+#endif
+
+// slots which stm32f4xx_defer_work() leaves free, one for each driver 
+// which drains its own queue with a single work item (GPIO edges)
+#define STM32F4xx_DEFERRED_WORK_RESERVED    1
+
+_Static_assert(STM32F4xx_DEFERRED_WORK_SIZE > STM32F4xx_DEFERRED_WORK_RESERVED,
+               "deferred work queue has no unreserved slots");
+
+// work item of the deferred work queue
+typedef void (*stm32f4xx_work_t)(void *context);
+
+// queues fn(context) and sets PendSV pending, which runs the queued items 
+// at the lowest priority once no other interrupt is active. Can be called
+// from any context, e.g. nested interrupts. Returns E_STATE_ERR if the 
+// unreserved slots are full, the item is not queued then.
+std_return_type_t stm32f4xx_defer_work(stm32f4xx_work_t fn, void *context);
+
+// queues fn(context) into the reserved slots, which never fails as long 
+// as each owner of a reserved slot has at most one item queued
+std_return_type_t stm32f4xx_defer_reserved_work(stm32f4xx_work_t fn, void *context);
+
+// record of a deferred driver callback. The driver embeds it as first 
+// member of a struct which holds the snapshot of the callback and its 
+// arguments, taken in the interrupt, so the callback gets the state of 
+// the event even if the driver is reconfigured before it runs.
+typedef struct _stm32f4xx_deferred_call
+{
+    volatile boolean queued;            // the snapshot belongs to the queue
+} stm32f4xx_deferred_call_t;
+
+// claims call for a new snapshot, returns FALSE and counts the call as 
+// dropped while the previous snapshot is still queued
+boolean stm32f4xx_claim_call(stm32f4xx_deferred_call_t *call);
+
+// queues fn(call) for the claimed call, fn runs at the lowest priority 
+// and has to release the call once it has copied the snapshot. If the queue is 
+// full the call is dropped and counted, callbacks never run in the 
+// interrupt which claimed them.
+void stm32f4xx_defer_call(stm32f4xx_deferred_call_t *call, stm32f4xx_work_t fn);
+
+// hands the record back to the driver
+void stm32f4xx_release_call(stm32f4xx_deferred_call_t *call);
+
+// number of calls dropped since reset
+uint32_t stm32f4xx_get_dropped_calls(void);
+
+// runs the queued work items in the order they were queued and returns 
+// their number. Called by PendSV_Handler, an application which overrides
+// PendSV_Handler (e.g. for the context switch of an RTOS) has to call it
+// from one context only.
+uint32_t stm32f4xx_run_deferred_work(void);
+
+// copies the vector table from flash to SRAM and points VTOR to the copy, 
+// returns E_STATE_INIT if the table is already in SRAM
+std_return_type_t stm32f4xx_relocate_vector_table(void);
+
+// installs handler as vector of irq, the vector table is relocated to 
+// SRAM on first use. Takes effect with the next interrupt, i.e. the IRQ 
+// may stay enabled.
+std_return_type_t stm32f4xx_register_irq_handler(STM32F4xx_IRQ_t irq, void (*handler)(void));
+
+// reinstalls the vector of irq from the flash vector table, e.g. the weak 
+// handler replaced by stm32f4xx_register_irq_handler()
+std_return_type_t stm32f4xx_restore_irq_handler(STM32F4xx_IRQ_t irq);
+
 
 
 #endif
\ No newline at end of file
@@ -51,6 +51,17 @@ void Reset_Handler(void)
         *bss_ptr++ = 0;
     }
 
+    /* Start all IRQs below the critical section threshold, four priority 
+       bytes per register */
+    for (uint8_t i = 0; i <= STM32F4xx_STM32F4XX_MAX_IRQ / 4; i++) {
+        STM32F4xx_NVIC->NVIC_IPR0[i] = 0x01010101UL * 
+            (STM32F4xx_CRITICAL_PRIORITY << (8 - STM32F4xx_NVIC_PRIO_BITS));
+    }
+
+    /* Deferred work runs after all other interrupts */
+    STM32F4xx_SCB->SCB_SHPR[2] |= (uint32_t) (STM32F4xx_NVIC_MAX_PRIORITY << (8 - STM32F4xx_NVIC_PRIO_BITS)) 
+                                  << STM32F4xx_SCB_SHPR3_PENDSV_POS;
+
     /* Branch to main function */
     main();
 